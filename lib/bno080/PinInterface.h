@@ -32,6 +32,8 @@ public:
 	virtual int digitalRead() = 0;
 	virtual void pinMode(uint8_t mode) = 0;
 	virtual void digitalWrite(uint8_t val) = 0;
+	// True if digitalRead() reads a GPIO of the MCU itself instead of going over a bus
+	[[nodiscard]] virtual bool isDirect() const { return false; }
 
 	[[nodiscard]] virtual std::string toString() const = 0;
 };
@@ -116,6 +116,10 @@ namespace I2CSCAN {
         scanState = ScanState::SCANNING;
 	}
 
+    bool isScanning() {
+        return scanState == ScanState::SCANNING;
+    }
+
     void update() {
         if (scanState != ScanState::SCANNING) {
             return;
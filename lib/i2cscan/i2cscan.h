@@ -7,6 +7,7 @@
 namespace I2CSCAN {
     void scani2cports();
     void update();
+    bool isScanning();
     bool checkI2C(uint8_t i, uint8_t j);
     bool hasDevOnBus(uint8_t addr);
     uint8_t pickDevice(uint8_t addr1, uint8_t addr2, bool scanIfNotFound);
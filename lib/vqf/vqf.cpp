@@ -4,6 +4,9 @@
 
 // Modified to add timestamps in: updateGyr(const vqf_real_t gyr[3], vqf_real_t gyrTs)
 // Removed batch update functions
+// Replaced the direct form Butterworth filters with a float-stable state-variable form
+// Added gyro pre-integration (VQF_GYR_PREINTEGRATION)
+// Cache the orientation outputs and rotation matrix between updates
 
 #include "vqf.h"
 
@@ -42,7 +45,7 @@ void VQF::updateGyr(const vqf_real_t gyr[3], vqf_real_t gyrTs)
 {
     // rest detection
     if (params.restBiasEstEnabled || params.magDistRejectionEnabled) {
-        filterVec(gyr, 3, params.restFilterTau, coeffs.gyrTs, coeffs.restGyrLpB, coeffs.restGyrLpA,
+        filterVec(gyr, 3, params.restFilterTau, coeffs.gyrTs, coeffs.restGyrLpCoeffs,
                   state.restGyrLpState, state.restLastGyrLp);
 
         state.restLastSquaredDeviations[0] = square(gyr[0] - state.restLastGyrLp[0])
@@ -60,15 +63,65 @@ void VQF::updateGyr(const vqf_real_t gyr[3], vqf_real_t gyrTs)
     // remove estimated gyro bias
     vqf_real_t gyrNoBias[3] = {gyr[0]-state.bias[0], gyr[1]-state.bias[1], gyr[2]-state.bias[2]};
     // gyroscope prediction step
-    vqf_real_t gyrNorm = norm(gyrNoBias, 3);
-    vqf_real_t angle = gyrNorm * gyrTs;
-    if (gyrNorm > EPS) {
-        vqf_real_t c = cos(angle/2);
-        vqf_real_t s = sin(angle/2)/gyrNorm;
-        vqf_real_t gyrStepQuat[4] = {c, s*gyrNoBias[0], s*gyrNoBias[1], s*gyrNoBias[2]};
-        quatMultiply(state.gyrQuat, gyrStepQuat, state.gyrQuat);
+    vqf_real_t stepQuat[4];
+    if (gyrStepQuat(gyrNoBias, gyrTs, stepQuat)) {
+        invalidateOutputCache();
+#ifdef VQF_GYR_PREINTEGRATION
+        // the bias only changes in updateAcc, so the samples up to there can be applied in one step
+        quatMultiply(state.gyrPreintQuat, stepQuat, state.gyrPreintQuat);
+#else
+        quatMultiply(state.gyrQuat, stepQuat, state.gyrQuat);
         normalize(state.gyrQuat, 4);
+#endif
+    }
+}
+
+bool VQF::gyrStepQuat(const vqf_real_t gyr[3], vqf_real_t Ts, vqf_real_t out[4])
+{
+    vqf_real_t gyrNormSq = gyr[0]*gyr[0] + gyr[1]*gyr[1] + gyr[2]*gyr[2];
+    if (gyrNormSq <= EPS*EPS) {
+        return false;
+    }
+    vqf_real_t c, s;
+    vqf_real_t halfAngleSq = gyrNormSq*Ts*Ts/4;
+    if (halfAngleSq < vqf_real_t(0.0625)) {
+        // Taylor series of cos(angle/2) and sin(angle/2)/gyrNorm, the truncation error is below 1e-8 up to a half
+        // angle of 0.25 rad (over 2800 deg/s at 100 Hz)
+        c = 1 - halfAngleSq/2*(1 - halfAngleSq/12*(1 - halfAngleSq/30));
+        s = Ts/2*(1 - halfAngleSq/6*(1 - halfAngleSq/20*(1 - halfAngleSq/42)));
+    } else {
+        vqf_real_t gyrNorm = sqrt(gyrNormSq);
+        vqf_real_t angle = gyrNorm * Ts;
+        c = cos(angle/2);
+        s = sin(angle/2)/gyrNorm;
+    }
+    out[0] = c;
+    out[1] = s*gyr[0];
+    out[2] = s*gyr[1];
+    out[3] = s*gyr[2];
+    return true;
+}
+
+#ifdef VQF_GYR_PREINTEGRATION
+void VQF::applyGyrPreintegration()
+{
+    if (state.gyrPreintQuat[1] == 0 && state.gyrPreintQuat[2] == 0 && state.gyrPreintQuat[3] == 0) {
+        return;
     }
+    quatMultiply(state.gyrQuat, state.gyrPreintQuat, state.gyrQuat);
+    normalize(state.gyrQuat, 4);
+    quatSetToIdentity(state.gyrPreintQuat);
+}
+#endif
+
+void VQF::getGyrQuat(vqf_real_t out[4]) const
+{
+#ifdef VQF_GYR_PREINTEGRATION
+    quatMultiply(state.gyrQuat, state.gyrPreintQuat, out);
+    normalize(out, 4);
+#else
+    std::copy(state.gyrQuat, state.gyrQuat+4, out);
+#endif
 }
 
 void VQF::updateAcc(const vqf_real_t acc[3])
@@ -78,9 +131,13 @@ void VQF::updateAcc(const vqf_real_t acc[3])
         return;
     }
 
+#ifdef VQF_GYR_PREINTEGRATION
+    applyGyrPreintegration();
+#endif
+
     // rest detection
     if (params.restBiasEstEnabled) {
-        filterVec(acc, 3, params.restFilterTau, coeffs.accTs, coeffs.restAccLpB, coeffs.restAccLpA,
+        filterVec(acc, 3, params.restFilterTau, coeffs.accTs, coeffs.restAccLpCoeffs,
                   state.restAccLpState, state.restLastAccLp);
 
         state.restLastSquaredDeviations[1] = square(acc[0] - state.restLastAccLp[0])
@@ -101,7 +158,7 @@ void VQF::updateAcc(const vqf_real_t acc[3])
 
     // filter acc in inertial frame
     quatRotate(state.gyrQuat, acc, accEarth);
-    filterVec(accEarth, 3, params.tauAcc, coeffs.accTs, coeffs.accLpB, coeffs.accLpA, state.accLpState, state.lastAccLp);
+    filterVec(accEarth, 3, params.tauAcc, coeffs.accTs, coeffs.accLpCoeffs, state.accLpState, state.lastAccLp);
 
     // transform to 6D earth frame and normalize
     quatRotate(state.accQuat, state.lastAccLp, accEarth);
@@ -124,6 +181,7 @@ void VQF::updateAcc(const vqf_real_t acc[3])
     }
     quatMultiply(accCorrQuat, state.accQuat, state.accQuat);
     normalize(state.accQuat, 4);
+    invalidateOutputCache();
 
     // calculate correction angular rate to facilitate debugging
     state.lastAccCorrAngularRate = acos(accEarth[2])/coeffs.accTs;
@@ -133,29 +191,19 @@ void VQF::updateAcc(const vqf_real_t acc[3])
     if (params.motionBiasEstEnabled || params.restBiasEstEnabled) {
         vqf_real_t biasClip = params.biasClip*vqf_real_t(M_PI/180.0);
 
-        vqf_real_t accGyrQuat[4];
         vqf_real_t R[9];
         vqf_real_t biasLp[2];
 
         // get rotation matrix corresponding to accGyrQuat
-        getQuat6D(accGyrQuat);
-        R[0] = 1 - 2*square(accGyrQuat[2]) - 2*square(accGyrQuat[3]); // r11
-        R[1] = 2*(accGyrQuat[2]*accGyrQuat[1] - accGyrQuat[0]*accGyrQuat[3]); // r12
-        R[2] = 2*(accGyrQuat[0]*accGyrQuat[2] + accGyrQuat[3]*accGyrQuat[1]); // r13
-        R[3] = 2*(accGyrQuat[0]*accGyrQuat[3] + accGyrQuat[2]*accGyrQuat[1]); // r21
-        R[4] = 1 - 2*square(accGyrQuat[1]) - 2*square(accGyrQuat[3]); // r22
-        R[5] = 2*(accGyrQuat[2]*accGyrQuat[3] - accGyrQuat[1]*accGyrQuat[0]); // r23
-        R[6] = 2*(accGyrQuat[3]*accGyrQuat[1] - accGyrQuat[0]*accGyrQuat[2]); // r31
-        R[7] = 2*(accGyrQuat[0]*accGyrQuat[1] + accGyrQuat[3]*accGyrQuat[2]); // r32
-        R[8] = 1 - 2*square(accGyrQuat[1]) - 2*square(accGyrQuat[2]); // r33
+        getRotationMatrix6D(R);
 
         // calculate R*b_hat (only the x and y component, as z is not needed)
         biasLp[0] = R[0]*state.bias[0] + R[1]*state.bias[1] + R[2]*state.bias[2];
         biasLp[1] = R[3]*state.bias[0] + R[4]*state.bias[1] + R[5]*state.bias[2];
 
         // low-pass filter R and R*b_hat
-        filterVec(R, 9, params.tauAcc, coeffs.accTs, coeffs.accLpB, coeffs.accLpA, state.motionBiasEstRLpState, R);
-        filterVec(biasLp, 2, params.tauAcc, coeffs.accTs, coeffs.accLpB, coeffs.accLpA, state.motionBiasEstBiasLpState,
+        filterVec(R, 9, params.tauAcc, coeffs.accTs, coeffs.accLpCoeffs, state.motionBiasEstRLpState, R);
+        filterVec(biasLp, 2, params.tauAcc, coeffs.accTs, coeffs.accLpCoeffs, state.motionBiasEstBiasLpState,
                   biasLp);
 
         // set measurement error and covariance for the respective Kalman filter update
@@ -259,6 +307,10 @@ void VQF::updateMag(const vqf_real_t mag[3])
         return;
     }
 
+#ifdef VQF_GYR_PREINTEGRATION
+    applyGyrPreintegration();
+#endif
+
     vqf_real_t magEarth[3];
 
     // bring magnetometer measurement into 6D earth frame
@@ -271,8 +323,8 @@ void VQF::updateMag(const vqf_real_t mag[3])
         state.magNormDip[1] = -asin(magEarth[2]/state.magNormDip[0]);
 
         if (params.magCurrentTau > 0) {
-            filterVec(state.magNormDip, 2, params.magCurrentTau, coeffs.magTs, coeffs.magNormDipLpB,
-                      coeffs.magNormDipLpA, state.magNormDipLpState, state.magNormDip);
+            filterVec(state.magNormDip, 2, params.magCurrentTau, coeffs.magTs, coeffs.magNormDipLpCoeffs,
+                      state.magNormDipLpState, state.magNormDip);
         }
 
         // magnetic disturbance detection
@@ -356,6 +408,7 @@ void VQF::updateMag(const vqf_real_t mag[3])
 
     // first-order filter step
     state.delta += k*state.lastMagDisAngle;
+    invalidateOutputCache(true);
     // calculate correction angular rate to facilitate debugging
     state.lastMagCorrAngularRate = k*state.lastMagDisAngle/coeffs.magTs;
 
@@ -369,18 +422,64 @@ void VQF::updateMag(const vqf_real_t mag[3])
 
 void VQF::getQuat3D(vqf_real_t out[4]) const
 {
-    std::copy(state.gyrQuat, state.gyrQuat+4, out);
+    getGyrQuat(out);
 }
 
 void VQF::getQuat6D(vqf_real_t out[4]) const
 {
-    quatMultiply(state.accQuat, state.gyrQuat, out);
+    if (!cache.quat6DValid) {
+        vqf_real_t gyrQuat[4];
+        getGyrQuat(gyrQuat);
+        quatMultiply(state.accQuat, gyrQuat, cache.quat6D);
+        cache.quat6DValid = true;
+    }
+    std::copy(cache.quat6D, cache.quat6D+4, out);
 }
 
 void VQF::getQuat9D(vqf_real_t out[4]) const
 {
-    quatMultiply(state.accQuat, state.gyrQuat, out);
-    quatApplyDelta(out, state.delta, out);
+    if (!cache.quat9DValid) {
+        getQuat6D(cache.quat9D);
+        quatApplyDelta(cache.quat9D, state.delta, cache.quat9D);
+        cache.quat9DValid = true;
+    }
+    std::copy(cache.quat9D, cache.quat9D+4, out);
+}
+
+void VQF::getRotationMatrix6D(vqf_real_t out[9]) const
+{
+    if (!cache.RValid) {
+        vqf_real_t q[4];
+        getQuat6D(q);
+        vqf_real_t* R = cache.R;
+        R[0] = 1 - 2*square(q[2]) - 2*square(q[3]); // r11
+        R[1] = 2*(q[2]*q[1] - q[0]*q[3]); // r12
+        R[2] = 2*(q[0]*q[2] + q[3]*q[1]); // r13
+        R[3] = 2*(q[0]*q[3] + q[2]*q[1]); // r21
+        R[4] = 1 - 2*square(q[1]) - 2*square(q[3]); // r22
+        R[5] = 2*(q[2]*q[3] - q[1]*q[0]); // r23
+        R[6] = 2*(q[3]*q[1] - q[0]*q[2]); // r31
+        R[7] = 2*(q[0]*q[1] + q[3]*q[2]); // r32
+        R[8] = 1 - 2*square(q[1]) - 2*square(q[2]); // r33
+        cache.RValid = true;
+    }
+    std::copy(cache.R, cache.R+9, out);
+}
+
+void VQF::getGravity(vqf_real_t out[3]) const
+{
+    vqf_real_t R[9];
+    getRotationMatrix6D(R);
+    std::copy(R+6, R+9, out);
+}
+
+void VQF::invalidateOutputCache(bool headingOnly)
+{
+    cache.quat9DValid = false;
+    if (!headingOnly) {
+        cache.quat6DValid = false;
+        cache.RValid = false;
+    }
 }
 
 vqf_real_t VQF::getDelta() const
@@ -502,29 +601,8 @@ void VQF::setTauAcc(vqf_real_t tauAcc)
         return;
     }
     params.tauAcc = tauAcc;
-    vqf_real_t newB[3];
-    vqf_real_t newA[3];
-
-    filterCoeffs(params.tauAcc, coeffs.accTs, newB, newA);
-    filterAdaptStateForCoeffChange(state.lastAccLp, 3, coeffs.accLpB, coeffs.accLpA, newB, newA, state.accLpState);
-
-#ifndef VQF_NO_MOTION_BIAS_ESTIMATION
-    // For R and biasLP, the last value is not saved in the state.
-    // Since b0 is small (at reasonable settings), the last output is close to state[0].
-    vqf_real_t R[9];
-    for (size_t i = 0; i < 9; i++) {
-        R[i] = state.motionBiasEstRLpState[2*i];
-    }
-    filterAdaptStateForCoeffChange(R, 9, coeffs.accLpB, coeffs.accLpA, newB, newA, state.motionBiasEstRLpState);
-    vqf_real_t biasLp[2];
-    for (size_t i = 0; i < 2; i++) {
-        biasLp[i] = state.motionBiasEstBiasLpState[2*i];
-    }
-    filterAdaptStateForCoeffChange(biasLp, 2, coeffs.accLpB, coeffs.accLpA, newB, newA, state.motionBiasEstBiasLpState);
-#endif
-
-    std::copy(newB, newB+3, coeffs.accLpB);
-    std::copy(newA, newA+2, coeffs.accLpA);
+    // the filter states do not depend on the coefficients, so they can be kept as they are
+    filterCoeffs(params.tauAcc, coeffs.accTs, coeffs.accLpCoeffs);
 }
 
 void VQF::setTauMag(vqf_real_t tauMag)
@@ -557,13 +635,18 @@ const VQFState& VQF::getState() const
 void VQF::setState(const VQFState& state)
 {
     this->state = state;
+    invalidateOutputCache();
 }
 
 void VQF::resetState()
 {
     quatSetToIdentity(state.gyrQuat);
+#ifdef VQF_GYR_PREINTEGRATION
+    quatSetToIdentity(state.gyrPreintQuat);
+#endif
     quatSetToIdentity(state.accQuat);
     state.delta = 0.0;
+    invalidateOutputCache();
 
     state.restDetected = false;
     state.magDistDetected = true;
@@ -696,56 +779,41 @@ vqf_real_t VQF::gainFromTau(vqf_real_t tau, vqf_real_t Ts)
     }
 }
 
-void VQF::filterCoeffs(vqf_real_t tau, vqf_real_t Ts, vqf_real_t outB[], vqf_real_t outA[])
+void VQF::filterCoeffs(vqf_real_t tau, vqf_real_t Ts, vqf_real_t out[])
 {
     assert(tau > 0);
     assert(Ts > 0);
-    // second order Butterworth filter based on https://stackoverflow.com/a/52764064
+    // second order Butterworth filter based on https://stackoverflow.com/a/52764064, run as a trapezoidal
+    // state-variable filter (https://cytomic.com/files/dsp/SvfLinearTrapOptimised2.pdf) so that the
+    // coefficients stay well-conditioned in single precision when fc is far below the sampling rate
     vqf_real_t fc = (M_SQRT2 / (2.0*M_PI))/vqf_real_t(tau); // time constant of dampened, non-oscillating part of step response
-    vqf_real_t C = tan(M_PI*fc*vqf_real_t(Ts));
-    vqf_real_t D = C*C + sqrt(2)*C + 1;
-    vqf_real_t b0 = C*C/D;
-    outB[0] = b0;
-    outB[1] = 2*b0;
-    outB[2] = b0;
-    // a0 = 1.0
-    outA[0] = 2*(C*C-1)/D; // a1
-    outA[1] = (1-sqrt(2)*C+C*C)/D; // a2
+    vqf_real_t g = tan(M_PI*fc*vqf_real_t(Ts));
+    vqf_real_t c1 = 1/(1 + g*(g + vqf_real_t(M_SQRT2)));
+    out[0] = c1;
+    out[1] = g*c1;
+    out[2] = g*g*c1;
 }
 
-void VQF::filterInitialState(vqf_real_t x0, const vqf_real_t b[3], const vqf_real_t a[2], vqf_real_t out[])
+void VQF::filterInitialState(vqf_real_t x0, vqf_real_t out[])
 {
-    // initial state for steady state (equivalent to scipy.signal.lfilter_zi, obtained by setting y=x=x0 in the filter
-    // update equation)
-    out[0] = x0*(1 - b[0]);
-    out[1] = x0*(b[2] - a[1]);
-}
-
-void VQF::filterAdaptStateForCoeffChange(vqf_real_t last_y[], size_t N, const vqf_real_t b_old[],
-                                         const vqf_real_t a_old[], const vqf_real_t b_new[],
-                                         const vqf_real_t a_new[], vqf_real_t state[])
-{
-    if (isnan(state[0])) {
-        return;
-    }
-    for (size_t i = 0; i < N; i++) {
-        state[0+2*i] = state[0+2*i] + (b_old[0] - b_new[0])*last_y[i];
-        state[1+2*i] = state[1+2*i] + (b_old[1] - b_new[1] - a_old[0] + a_new[0])*last_y[i];
-    }
+    // steady state: the band-pass integrator is empty and the low-pass integrator holds the input
+    out[0] = 0;
+    out[1] = x0;
 }
 
-vqf_real_t VQF::filterStep(vqf_real_t x, const vqf_real_t b[3], const vqf_real_t a[2], vqf_real_t state[2])
+vqf_real_t VQF::filterStep(vqf_real_t x, const vqf_real_t c[3], vqf_real_t state[2])
 {
-    // difference equations based on scipy.signal.lfilter documentation
-    // assumes that a0 == 1.0
-    vqf_real_t y = b[0]*x + state[0];
-    state[0] = b[1]*x - a[0]*y + state[1];
-    state[1] = b[2]*x - a[1]*y;
-    return y;
+    // state[0] and state[1] are the trapezoidal integrator states of the band-pass and low-pass outputs
+    vqf_real_t v3 = x - state[1];
+    vqf_real_t v1 = c[0]*state[0] + c[1]*v3;
+    vqf_real_t v2 = state[1] + c[1]*state[0] + c[2]*v3;
+    state[0] = 2*v1 - state[0];
+    state[1] = 2*v2 - state[1];
+    return v2;
 }
 
-void VQF::filterVec(const vqf_real_t x[], size_t N, vqf_real_t tau, vqf_real_t Ts, const vqf_real_t b[3],
-                    const vqf_real_t a[2], vqf_real_t state[], vqf_real_t out[])
+void VQF::filterVec(const vqf_real_t x[], size_t N, vqf_real_t tau, vqf_real_t Ts, const vqf_real_t c[3],
+                    vqf_real_t state[], vqf_real_t out[])
 {
     assert(N>=2);
 
@@ -765,14 +833,14 @@ void VQF::filterVec(const vqf_real_t x[], size_t N, vqf_real_t tau, vqf_real_t T
         }
         if (state[1]*Ts >= tau) {
             for(size_t i = 0; i < N; i++) {
-               filterInitialState(out[i], b, a, state+2*i);
+               filterInitialState(out[i], state+2*i);
             }
         }
         return;
     }
 
     for (size_t i = 0; i < N; i++) {
-        out[i] = filterStep(x[i], b, a, state+2*i);
+        out[i] = filterStep(x[i], c, state+2*i);
     }
 }
 
@@ -876,7 +944,7 @@ void VQF::setup()
     assert(coeffs.accTs > 0);
     assert(coeffs.magTs > 0);
 
-    filterCoeffs(params.tauAcc, coeffs.accTs, coeffs.accLpB, coeffs.accLpA);
+    filterCoeffs(params.tauAcc, coeffs.accTs, coeffs.accLpCoeffs);
 
     coeffs.kMag = gainFromTau(params.tauMag, coeffs.magTs);
 
@@ -884,15 +952,14 @@ void VQF::setup()
     // the system noise increases the variance from 0 to (0.1 °/s)^2 in biasForgettingTime seconds
     updateBiasForgettingTime(params.biasForgettingTime);
 
-    filterCoeffs(params.restFilterTau, coeffs.gyrTs, coeffs.restGyrLpB, coeffs.restGyrLpA);
-    filterCoeffs(params.restFilterTau, coeffs.accTs, coeffs.restAccLpB, coeffs.restAccLpA);
+    filterCoeffs(params.restFilterTau, coeffs.gyrTs, coeffs.restGyrLpCoeffs);
+    filterCoeffs(params.restFilterTau, coeffs.accTs, coeffs.restAccLpCoeffs);
 
     coeffs.kMagRef = gainFromTau(params.magRefTau, coeffs.magTs);
     if (params.magCurrentTau > 0) {
-        filterCoeffs(params.magCurrentTau, coeffs.magTs, coeffs.magNormDipLpB, coeffs.magNormDipLpA);
+        filterCoeffs(params.magCurrentTau, coeffs.magTs, coeffs.magNormDipLpCoeffs);
     } else {
-        std::fill(coeffs.magNormDipLpB, coeffs.magNormDipLpB + 3, NaN);
-        std::fill(coeffs.magNormDipLpA, coeffs.magNormDipLpA + 2, NaN);
+        std::fill(coeffs.magNormDipLpCoeffs, coeffs.magNormDipLpCoeffs + 3, NaN);
     }
 
     resetState();
@@ -4,6 +4,9 @@
 
 // Modified to add timestamps in: updateGyr(const vqf_real_t gyr[3], vqf_real_t gyrTs)
 // Removed batch update functions
+// Replaced the direct form Butterworth filters with a float-stable state-variable form
+// Added gyro pre-integration (VQF_GYR_PREINTEGRATION)
+// Cache the orientation outputs and rotation matrix between updates
 
 #ifndef VQF_HPP
 #define VQF_HPP
@@ -11,6 +14,7 @@
 #include <stddef.h>
 
 #define VQF_SINGLE_PRECISION
+#define VQF_GYR_PREINTEGRATION
 #define M_PI 3.14159265358979323846
 #define M_SQRT2 1.41421356237309504880
 
@@ -18,9 +22,16 @@
  * @brief Typedef for the floating-point data type used for most operations.
  *
  * By default, all floating-point calculations are performed using `vqf_real_t`. Set the
- * `VQF_SINGLE_PRECISION` define to change this type to `float`. Note that the
- * Butterworth filter implementation will always use vqf_real_t precision as using floats
- * can cause numeric issues.
+ * `VQF_SINGLE_PRECISION` define to change this type to `float`. The Butterworth
+ * low-pass filters are implemented as state-variable filters, which stay accurate in
+ * single precision even at the low cutoff frequencies used here.
+ */
+/*
+ * When `VQF_GYR_PREINTEGRATION` is defined, gyroscope samples are folded into a
+ * pending delta quaternion (using a series expansion instead of trigonometric
+ * functions) and applied to the strapdown integration quaternion in one step before the
+ * next accelerometer or magnetometer update. Rest detection still runs per sample, and
+ * the quaternion getters include the pending rotation.
  */
 #ifndef VQF_SINGLE_PRECISION
 typedef double vqf_real_t;
@@ -324,6 +335,13 @@ struct VQFState {
 	 * \f$^{\mathcal{S}_i}_{\mathcal{I}_i}\mathbf{q}\f$.
 	 */
 	vqf_real_t gyrQuat[4];
+#ifdef VQF_GYR_PREINTEGRATION
+	/**
+	 * @brief Rotation of the gyroscope samples since the last accelerometer or
+	 * magnetometer update, not yet applied to #gyrQuat.
+	 */
+	vqf_real_t gyrPreintQuat[4];
+#endif
 	/**
 	 * @brief Inclination correction quaternion
 	 * \f$^{\mathcal{I}_i}_{\mathcal{E}_i}\mathbf{q}\f$.
@@ -538,17 +556,9 @@ struct VQFCoefficients {
 	vqf_real_t magTs;
 
 	/**
-	 * @brief Numerator coefficients of the acceleration low-pass filter.
-	 *
-	 * The array contains \f$\begin{bmatrix}b_0 & b_1 & b_2\end{bmatrix}\f$.
+	 * @brief Coefficients of the acceleration low-pass filter (see #filterCoeffs).
 	 */
-	vqf_real_t accLpB[3];
-	/**
-	 * @brief Denominator coefficients of the acceleration low-pass filter.
-	 *
-	 * The array contains \f$\begin{bmatrix}a_1 & a_2\end{bmatrix}\f$ and \f$a_0=1\f$.
-	 */
-	vqf_real_t accLpA[2];
+	vqf_real_t accLpCoeffs[3];
 
 	/**
 	 * @brief Gain of the first-order filter used for heading correction.
@@ -581,25 +591,15 @@ struct VQFCoefficients {
 	vqf_real_t biasRestW;
 
 	/**
-	 * @brief Numerator coefficients of the gyroscope measurement low-pass filter for
-	 * rest detection.
-	 */
-	vqf_real_t restGyrLpB[3];
-	/**
-	 * @brief Denominator coefficients of the gyroscope measurement low-pass filter for
-	 * rest detection.
-	 */
-	vqf_real_t restGyrLpA[2];
-	/**
-	 * @brief Numerator coefficients of the accelerometer measurement low-pass filter
-	 * for rest detection.
+	 * @brief Coefficients of the gyroscope measurement low-pass filter for rest
+	 * detection.
 	 */
-	vqf_real_t restAccLpB[3];
+	vqf_real_t restGyrLpCoeffs[3];
 	/**
-	 * @brief Denominator coefficients of the accelerometer measurement low-pass filter
-	 * for rest detection.
+	 * @brief Coefficients of the accelerometer measurement low-pass filter for rest
+	 * detection.
 	 */
-	vqf_real_t restAccLpA[2];
+	vqf_real_t restAccLpCoeffs[3];
 
 	/**
 	 * @brief Gain of the first-order filter used for to update the magnetic field
@@ -607,15 +607,10 @@ struct VQFCoefficients {
 	 */
 	vqf_real_t kMagRef;
 	/**
-	 * @brief Numerator coefficients of the low-pass filter for the current magnetic
-	 * norm and dip.
-	 */
-	vqf_real_t magNormDipLpB[3];
-	/**
-	 * @brief Denominator coefficients of the low-pass filter for the current magnetic
-	 * norm and dip.
+	 * @brief Coefficients of the low-pass filter for the current magnetic norm and
+	 * dip.
 	 */
-	vqf_real_t magNormDipLpA[2];
+	vqf_real_t magNormDipLpCoeffs[3];
 };
 
 /**
@@ -765,6 +760,20 @@ public:
 	 * @param out output array for the quaternion
 	 */
 	void getQuat9D(vqf_real_t out[4]) const;
+	/**
+	 * @brief Returns the rotation matrix of the 6D orientation quaternion.
+	 * @param out output array of size 9 (3x3 matrix stored in row-major order)
+	 */
+	void getRotationMatrix6D(vqf_real_t out[9]) const;
+	/**
+	 * @brief Returns the direction of gravity in the sensor frame as a unit vector.
+	 *
+	 * This is the last row of the 6D rotation matrix, and is the same for the 9D
+	 * orientation.
+	 *
+	 * @param out output array of size 3
+	 */
+	void getGravity(vqf_real_t out[3]) const;
 	/**
 	 * @brief Returns the heading difference \f$\delta\f$ between \f$\mathcal{E}_i\f$
 	 * and \f$\mathcal{E}\f$.
@@ -922,6 +931,20 @@ public:
 	 * \sin\frac{\delta}{2}\end{bmatrix} \otimes \mathbf{q}\f$
 	 */
 	static void quatApplyDelta(vqf_real_t q[4], vqf_real_t delta, vqf_real_t out[4]);
+	/**
+	 * @brief Calculates the rotation quaternion for one gyroscope sample.
+	 *
+	 * \f$\mathbf{q}_\mathrm{out} = \begin{bmatrix}\cos\frac{\theta}{2} &
+	 * \frac{\boldsymbol{\omega}}{\|\boldsymbol{\omega}\|}\sin\frac{\theta}{2}
+	 * \end{bmatrix}\f$ with \f$\theta = \|\boldsymbol{\omega}\| T_\mathrm{s}\f$.
+	 * Half angles below 0.25 rad use a series expansion instead of sqrt, sin and cos.
+	 *
+	 * @param gyr angular velocity in rad/s
+	 * @param Ts sampling time \f$T_\mathrm{s}\f$ in seconds
+	 * @param out output quaternion
+	 * @return false if the angular velocity is zero (out is not written)
+	 */
+	static bool gyrStepQuat(const vqf_real_t gyr[3], vqf_real_t Ts, vqf_real_t out[4]);
 	/**
 	 * @brief Rotates a vector with a given quaternion.
 	 *
@@ -973,61 +996,37 @@ public:
 	 * part of step response and the resulting cutoff frequency is \f$f_\mathrm{c} =
 	 * \frac{\sqrt{2}}{2\pi\tau}\f$.
 	 *
+	 * The filter is run as a trapezoidal state-variable filter, which has the same
+	 * transfer function as the bilinear-transformed biquad but is parametrized by
+	 * \f$g = \tan(\pi f_\mathrm{c} T_\mathrm{s})\f$ instead of coefficients that all
+	 * approach \f$\pm 1\f$ or 0 at low cutoff frequencies. With \f$k = \sqrt{2}\f$ and
+	 * \f$c_1 = \frac{1}{1 + g(g + k)}\f$, the output array contains
+	 * \f$\begin{bmatrix}c_1 & g c_1 & g^2 c_1\end{bmatrix}\f$.
+	 *
 	 * @param tau time constant \f$\tau\f$ in seconds
 	 * @param Ts sampling time \f$T_\mathrm{s}\f$ in seconds
-	 * @param outB output array for numerator coefficients
-	 * @param outA output array for denominator coefficients (without \f$a_0=1\f$)
+	 * @param out output array for filter coefficients
 	 */
-	static void
-	filterCoeffs(vqf_real_t tau, vqf_real_t Ts, vqf_real_t outB[3], vqf_real_t outA[2]);
+	static void filterCoeffs(vqf_real_t tau, vqf_real_t Ts, vqf_real_t out[3]);
 	/**
 	 * @brief Calculates the initial filter state for a given steady-state value.
-	 * @param x0 steady state value
-	 * @param b numerator coefficients
-	 * @param a denominator coefficients (without \f$a_0=1\f$)
-	 * @param out output array for filter state
-	 */
-	static void filterInitialState(
-		vqf_real_t x0,
-		const vqf_real_t b[],
-		const vqf_real_t a[],
-		vqf_real_t out[2]
-	);
-	/**
-	 * @brief Adjusts the filter state when changing coefficients.
 	 *
-	 * This function assumes that the filter is currently in a steady state, i.e. the
-	 * last input values and the last output values are all equal. Based on this, the
-	 * filter state is adjusted to new filter coefficients so that the output does not
-	 * jump.
+	 * The steady state does not depend on the filter coefficients, so the state can be
+	 * kept as is when the coefficients change.
 	 *
-	 * @param last_y last filter output values (array of size N)
-	 * @param N number of values in vector-valued signal
-	 * @param b_old previous numerator coefficients
-	 * @param a_old previous denominator coefficients (without \f$a_0=1\f$)
-	 * @param b_new new numerator coefficients
-	 * @param a_new new denominator coefficients (without \f$a_0=1\f$)
-	 * @param state filter state (array of size N*2, will be modified)
+	 * @param x0 steady state value
+	 * @param out output array for filter state
 	 */
-	static void filterAdaptStateForCoeffChange(
-		vqf_real_t last_y[],
-		size_t N,
-		const vqf_real_t b_old[3],
-		const vqf_real_t a_old[2],
-		const vqf_real_t b_new[3],
-		const vqf_real_t a_new[2],
-		vqf_real_t state[]
-	);
+	static void filterInitialState(vqf_real_t x0, vqf_real_t out[2]);
 	/**
 	 * @brief Performs a filter step for a scalar value.
 	 * @param x input value
-	 * @param b numerator coefficients
-	 * @param a denominator coefficients (without \f$a_0=1\f$)
+	 * @param c filter coefficients (see #filterCoeffs)
 	 * @param state filter state array (will be modified)
 	 * @return filtered value
 	 */
 	static vqf_real_t
-	filterStep(vqf_real_t x, const vqf_real_t b[3], const vqf_real_t a[2], vqf_real_t state[2]);
+	filterStep(vqf_real_t x, const vqf_real_t c[3], vqf_real_t state[2]);
 	/**
 	 * @brief Performs filter step for vector-valued signal with averaging-based
 	 * initialization.
@@ -1035,15 +1034,13 @@ public:
 	 * During the first \f$\tau\f$ seconds, the filter output is the mean of the
 	 * previous samples. At \f$t=\tau\f$, the initial conditions for the low-pass filter
 	 * are calculated based on the current mean value and from then on, regular
-	 * filtering with the rational transfer function described by the coefficients b and
-	 * a is performed.
+	 * filtering with the coefficients c is performed.
 	 *
 	 * @param x input values (array of size N)
 	 * @param N number of values in vector-valued signal
 	 * @param tau filter time constant \f$\tau\f$ in seconds (used for initialization)
 	 * @param Ts sampling time \f$T_\mathrm{s}\f$ in seconds (used for initialization)
-	 * @param b numerator coefficients
-	 * @param a denominator coefficients (without \f$a_0=1\f$)
+	 * @param c filter coefficients (see #filterCoeffs)
 	 * @param state filter state (array of size N*2, will be modified)
 	 * @param out output array for filtered values (size N)
 	 */
@@ -1052,8 +1049,7 @@ public:
 		size_t N,
 		vqf_real_t tau,
 		vqf_real_t Ts,
-		const vqf_real_t b[3],
-		const vqf_real_t a[2],
+		const vqf_real_t c[3],
 		vqf_real_t state[],
 		vqf_real_t out[]
 	);
@@ -1120,6 +1116,23 @@ protected:
 	 * @brief Calculates coefficients based on parameters and sampling rates.
 	 */
 	void setup();
+#ifdef VQF_GYR_PREINTEGRATION
+	/**
+	 * @brief Applies the pending gyroscope rotation to the strapdown integration
+	 * quaternion.
+	 */
+	void applyGyrPreintegration();
+#endif
+	/**
+	 * @brief Returns the strapdown integration quaternion including any pending
+	 * gyroscope rotation.
+	 */
+	void getGyrQuat(vqf_real_t out[4]) const;
+	/**
+	 * @brief Marks the cached orientation outputs as outdated.
+	 * @param headingOnly true if only the heading difference changed
+	 */
+	void invalidateOutputCache(bool headingOnly = false);
 
 	/**
 	 * @brief Contains the current parameters.
@@ -1142,6 +1155,22 @@ protected:
 	 * See #getCoeffs.
 	 */
 	VQFCoefficients coeffs;
+
+	/**
+	 * @brief Orientation outputs derived from the state.
+	 *
+	 * Each output is computed on first use after an update and then reused by
+	 * updateAcc, updateMag and the getters until the next update changes the state.
+	 */
+	struct OutputCache {
+		vqf_real_t quat6D[4];
+		vqf_real_t quat9D[4];
+		vqf_real_t R[9];
+		bool quat6DValid = false;
+		bool quat9DValid = false;
+		bool RValid = false;
+	};
+	mutable OutputCache cache;
 };
 
 #endif  // VQF_HPP
@@ -60,6 +60,8 @@ void BatteryMonitor::Loop() {
 	if (now_ms - last_battery_sample >= batterySampleRate) {
 		last_battery_sample = now_ms;
 		voltage = -1;
+		// The monitors on the I2C bus share it with the sensors
+		auto sensorLock = sensorManager.lockSensors();
 #if ESP8266 \
 	&& (BATTERY_MONITOR == BAT_INTERNAL || BATTERY_MONITOR == BAT_INTERNAL_MCP3021)
 		// Find out what your max measurement is (voltage_3_3).
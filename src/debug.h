@@ -85,6 +85,13 @@
 #define OPTIMIZE_UPDATES true
 
 #define I2C_SPEED 400000
+// After setup, buses on which every sensor reads fine at this clock are switched to
+// it. They step back down on their own if errors pile up. Off by default, boards
+// whose sensors and wiring were checked at Fast-mode Plus can set it to 1000000.
+// The bus with the battery monitor or MCP23X17 on it always stays at I2C_SPEED
+#ifndef I2C_FAST_SPEED
+#define I2C_FAST_SPEED I2C_SPEED
+#endif
 
 #define COMPLIANCE_MODE true
 #define USE_ATTENUATION COMPLIANCE_MODE&& ESP8266
@@ -112,6 +119,18 @@
 #define DEBUG_MEASURE_SENSOR_TIME_TAKEN false
 #endif
 
+// Runs sensor acquisition and fusion in a FreeRTOS task on the other core of dual
+// core ESP32s, the main loop only does the sending. Everything else that calls into
+// the sensors or uses their I2C bus (battery monitor, I2C scan, serial and network
+// commands) holds the sensor lock while doing so. Experimental
+#ifndef USE_SENSOR_TASK
+#define USE_SENSOR_TASK false
+#endif
+
+#ifndef SENSOR_TASK_CORE
+#define SENSOR_TASK_CORE 0
+#endif
+
 #ifndef USE_OTA_TIMEOUT
 #define USE_OTA_TIMEOUT false
 #endif
@@ -52,6 +52,7 @@ SlimeVR::Debugging::TimeTakenMeasurer sensorMeasurer{"Sensors"};
 int sensorToCalibrate = -1;
 bool blinking = false;
 unsigned long blinkStart = 0;
+constexpr unsigned long ImuBootTimeMillis = 500;
 unsigned long loopTime = 0;
 unsigned long lastStatePrint = 0;
 bool secondImuActive = false;
@@ -136,8 +137,11 @@ void setup() {
 #endif
 	Wire.setClock(I2C_SPEED);
 
-	// Wait for IMU to boot
-	delay(500);
+	// Wait for IMU to boot. The IMUs are powered up together with the MCU, so only
+	// wait for what's left after the startup above.
+	while (millis() < ImuBootTimeMillis) {
+		delay(1);
+	}
 
 	sensorManager.setup();
 
@@ -170,7 +174,10 @@ void loop() {
 
 	battery.Loop();
 	ledManager.update();
-	I2CSCAN::update();
+	if (I2CSCAN::isScanning()) {
+		auto sensorLock = sensorManager.lockSensors();
+		I2CSCAN::update();
+	}
 #ifdef TARGET_LOOPTIME_MICROS
 	long elapsed = (micros() - loopTime);
 	if (elapsed < TARGET_LOOPTIME_MICROS) {
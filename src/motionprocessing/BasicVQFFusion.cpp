@@ -0,0 +1,81 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#include "BasicVQFFusion.h"
+
+BasicVQFFusion::BasicVQFFusion(
+	const VQFParams& params,
+	sensor_real_t gyrTs,
+	sensor_real_t accTs,
+	sensor_real_t magTs
+)
+	: m_vqf(basicParams(params), gyrTs, accTs, magTs)
+	, m_restDetection(restParams(params), gyrTs, accTs > 0 ? accTs : gyrTs)
+	, m_accTs(accTs > 0 ? accTs : gyrTs) {}
+
+BasicVQFParams BasicVQFFusion::basicParams(const VQFParams& params) {
+	BasicVQFParams basic;
+	basic.tauAcc = params.tauAcc;
+	basic.tauMag = params.tauMag;
+	return basic;
+}
+
+RestDetectionParams BasicVQFFusion::restParams(const VQFParams& params) {
+	RestDetectionParams rest;
+	rest.biasClip = params.biasClip;
+	rest.restMinTime = params.restMinT;
+	rest.restFilterTau = params.restFilterTau;
+	rest.restThGyr = params.restThGyr;
+	rest.restThAcc = params.restThAcc;
+	return rest;
+}
+
+void BasicVQFFusion::updateGyr(const sensor_real_t gyr[3], sensor_real_t gyrTs) {
+	m_restDetection.updateGyr(gyr);
+	m_vqf.updateGyr(gyr, gyrTs);
+}
+
+void BasicVQFFusion::updateAcc(const sensor_real_t acc[3]) {
+	m_restDetection.updateAcc(m_accTs, acc);
+	m_vqf.updateAcc(acc);
+}
+
+void BasicVQFFusion::updateMag(const sensor_real_t mag[3]) { m_vqf.updateMag(mag); }
+
+void BasicVQFFusion::getQuat6D(sensor_real_t out[4]) const { m_vqf.getQuat6D(out); }
+
+void BasicVQFFusion::getQuat9D(sensor_real_t out[4]) const { m_vqf.getQuat9D(out); }
+
+void BasicVQFFusion::getGravity(sensor_real_t out[3]) const {
+	// Last row of the rotation matrix, the heading correction doesn't change it
+	sensor_real_t q[4];
+	m_vqf.getQuat6D(q);
+	out[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+	out[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+	out[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+void BasicVQFFusion::resetState() {
+	m_vqf.resetState();
+	m_restDetection.resetState();
+}
@@ -0,0 +1,73 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#ifndef BASIC_VQF_FUSION_H
+#define BASIC_VQF_FUSION_H
+
+#include <basicvqf.h>
+#include <vqf.h>
+
+#include "RestDetection.h"
+#include "types.h"
+
+// BasicVQF with the interface SensorFusion expects from a backend. BasicVQF only has
+// the accelerometer and magnetometer corrections, so this drops the gyro bias
+// estimation and magnetic disturbance rejection of the full VQF in exchange for less
+// work per sample. Rest detection, which the calibrators depend on, is done by a
+// separate RestDetection.
+//
+// Without bias estimation the heading drifts with whatever gyro bias the calibrator
+// leaves behind, so this is meant for IMUs with a runtime or temperature calibration.
+class BasicVQFFusion {
+public:
+	BasicVQFFusion(
+		const VQFParams& params,
+		sensor_real_t gyrTs,
+		sensor_real_t accTs = -1.0,
+		sensor_real_t magTs = -1.0
+	);
+
+	void updateGyr(const sensor_real_t gyr[3], sensor_real_t gyrTs);
+	void updateAcc(const sensor_real_t acc[3]);
+	void updateMag(const sensor_real_t mag[3]);
+
+	void getQuat6D(sensor_real_t out[4]) const;
+	void getQuat9D(sensor_real_t out[4]) const;
+	void getGravity(sensor_real_t out[3]) const;
+	bool getRestDetected() const { return m_restDetection.getRestDetected(); }
+
+	// There is no bias estimate to forget
+	void updateBiasForgettingTime(float biasForgettingTime) {}
+
+	void resetState();
+
+private:
+	static BasicVQFParams basicParams(const VQFParams& params);
+	static RestDetectionParams restParams(const VQFParams& params);
+
+	BasicVQF m_vqf;
+	RestDetection m_restDetection;
+	sensor_real_t m_accTs;
+};
+
+#endif
@@ -0,0 +1,352 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#include "FixedPointFusion.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr int32_t One = int32_t(1) << 30;
+
+int32_t toFixed(sensor_real_t x, int shift) {
+	sensor_real_t scaled = x * sensor_real_t(int64_t(1) << shift);
+	if (scaled >= sensor_real_t(INT32_MAX)) {
+		return INT32_MAX;
+	}
+	if (scaled <= sensor_real_t(INT32_MIN)) {
+		return INT32_MIN;
+	}
+	return static_cast<int32_t>(scaled);
+}
+
+int32_t mulQ30(int32_t a, int32_t b) {
+	return static_cast<int32_t>(
+		(static_cast<int64_t>(a) * b + (int64_t(1) << 29)) >> 30
+	);
+}
+
+int32_t clamp(int32_t x, int32_t limit) {
+	return x > limit ? limit : (x < -limit ? -limit : x);
+}
+
+uint32_t isqrt64(uint64_t x) {
+	uint64_t result = 0;
+	uint64_t bit = uint64_t(1) << 62;
+	while (bit > x) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (x >= result + bit) {
+			x -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	return static_cast<uint32_t>(result);
+}
+
+// Scales a vector of any Q format to a Q30 unit vector
+bool normalize(const int32_t in[3], int32_t out[3]) {
+	uint64_t normSq = 0;
+	for (int i = 0; i < 3; i++) {
+		normSq += static_cast<uint64_t>(static_cast<int64_t>(in[i]) * in[i]);
+	}
+	uint32_t norm = isqrt64(normSq);
+	if (norm == 0) {
+		return false;
+	}
+	// |in[i]| <= norm, so in[i] * invNorm stays within 2^62
+	int64_t invNorm = (int64_t(1) << 62) / norm;
+	for (int i = 0; i < 3; i++) {
+		out[i] = static_cast<int32_t>((in[i] * invNorm) >> 32);
+	}
+	return true;
+}
+
+void cross(const int32_t a[3], const int32_t b[3], int32_t out[3]) {
+	out[0] = static_cast<int32_t>(
+		(static_cast<int64_t>(a[1]) * b[2] - static_cast<int64_t>(a[2]) * b[1]) >> 30
+	);
+	out[1] = static_cast<int32_t>(
+		(static_cast<int64_t>(a[2]) * b[0] - static_cast<int64_t>(a[0]) * b[2]) >> 30
+	);
+	out[2] = static_cast<int32_t>(
+		(static_cast<int64_t>(a[0]) * b[1] - static_cast<int64_t>(a[1]) * b[0]) >> 30
+	);
+}
+
+int32_t gainToFixed(sensor_real_t tau, sensor_real_t Ts) {
+	return toFixed(VQF::gainFromTau(tau, Ts), 30);
+}
+
+int32_t inverseToFixed(sensor_real_t tau) {
+	return tau > 0 ? toFixed(1 / tau, 30) : 0;
+}
+
+}  // namespace
+
+FixedPointFusion::FixedPointFusion(
+	const VQFParams& params,
+	sensor_real_t gyrTs,
+	sensor_real_t accTs,
+	sensor_real_t magTs
+)
+	: m_params(params) {
+	accTs = accTs > 0 ? accTs : gyrTs;
+
+	m_kp = inverseToFixed(params.tauAcc);
+	m_kpMag = inverseToFixed(params.tauMag);
+	// The correction integral tracks gyro bias while moving. The loop is heavily
+	// overdamped (damping ratio 16) so linear acceleration doesn't leak into it; rest
+	// detection handles most of the bias anyway
+	sensor_real_t kp = params.tauAcc > 0 ? 1 / params.tauAcc : 0;
+	m_kiAccTs = params.motionBiasEstEnabled ? toFixed(kp * kp / 1024 * accTs, 30) : 0;
+	m_kRestGyr = gainToFixed(params.restFilterTau, gyrTs);
+	m_kRestAcc = gainToFixed(params.restFilterTau, accTs);
+
+	constexpr sensor_real_t DegToRad = sensor_real_t(M_PI / 180.0);
+	m_biasClip = toFixed(params.biasClip * DegToRad, 30);
+	int64_t restThGyr = toFixed(params.restThGyr * DegToRad, RateShift);
+	m_restThGyrSq = restThGyr * restThGyr;
+	int64_t restThAcc = toFixed(params.restThAcc, AccShift);
+	m_restThAccSq = restThAcc * restThAcc;
+	m_restMinT = toFixed(params.restMinT, 20);
+
+	resetState();
+}
+
+void FixedPointFusion::resetState() {
+	m_quat[0] = One;
+	for (int i = 0; i < 3; i++) {
+		m_quat[i + 1] = 0;
+		m_accError[i] = 0;
+		m_magError[i] = 0;
+		m_integral[i] = 0;
+		m_bias[i] = 0;
+		m_restGyrLp[i] = 0;
+		m_restAccLp[i] = 0;
+	}
+	m_restGyrLpReady = false;
+	m_restAccLpReady = false;
+	m_restT = 0;
+	m_restDetected = false;
+}
+
+void FixedPointFusion::updateGyr(const sensor_real_t gyr[3], sensor_real_t gyrTs) {
+	if (gyrTs <= 0) {
+		return;
+	}
+	if (gyrTs > 1) {
+		gyrTs = 1;
+	}
+
+	int32_t rate[3];
+	for (int i = 0; i < 3; i++) {
+		rate[i] = toFixed(gyr[i], RateShift);
+	}
+	updateRestDetection(rate, toFixed(gyrTs, 20));
+
+	// Half the rotation angle over this sample, corrected by the bias estimates and
+	// the latest accel/mag errors
+	int32_t halfDt = toFixed(gyrTs / 2, 30);
+	int64_t theta[3];
+	for (int i = 0; i < 3; i++) {
+		int32_t correction = m_integral[i] + mulQ30(m_kp, m_accError[i])
+						   + mulQ30(m_kpMag, m_magError[i]);
+		int64_t w = int64_t(rate[i]) - m_bias[i] + (correction >> (30 - RateShift));
+		theta[i] = (w * halfDt) >> RateShift;
+	}
+
+	// q += q * (0, theta)
+	int64_t q0 = m_quat[0], q1 = m_quat[1], q2 = m_quat[2], q3 = m_quat[3];
+	int64_t dq[4] = {
+		-q1 * theta[0] - q2 * theta[1] - q3 * theta[2],
+		q0 * theta[0] + q2 * theta[2] - q3 * theta[1],
+		q0 * theta[1] - q1 * theta[2] + q3 * theta[0],
+		q0 * theta[2] + q1 * theta[1] - q2 * theta[0],
+	};
+	for (int i = 0; i < 4; i++) {
+		m_quat[i] += static_cast<int32_t>(dq[i] >> 30);
+	}
+
+	// One Newton step of 1/sqrt(|q|^2) around 1. The quaternion is renormalized every
+	// sample, so it never strays far enough for the remaining error to build up
+	int64_t normSq = 0;
+	for (int i = 0; i < 4; i++) {
+		normSq += int64_t(m_quat[i]) * m_quat[i];
+	}
+	int32_t invNorm = static_cast<int32_t>((3 * int64_t(One) - (normSq >> 30)) >> 1);
+	for (int i = 0; i < 4; i++) {
+		m_quat[i] = mulQ30(m_quat[i], invNorm);
+	}
+}
+
+void FixedPointFusion::updateAcc(const sensor_real_t acc[3]) {
+	if (acc[0] == sensor_real_t(0.0) && acc[1] == sensor_real_t(0.0)
+		&& acc[2] == sensor_real_t(0.0)) {
+		return;
+	}
+
+	int32_t accFixed[3];
+	for (int i = 0; i < 3; i++) {
+		accFixed[i] = toFixed(acc[i], AccShift);
+	}
+
+	// Rest detection, the time is counted in updateGyr()
+	if (!m_restAccLpReady) {
+		for (int i = 0; i < 3; i++) {
+			m_restAccLp[i] = int64_t(accFixed[i]) << 30;
+		}
+		m_restAccLpReady = true;
+	}
+	int64_t deviationSq = 0;
+	for (int i = 0; i < 3; i++) {
+		m_restAccLp[i] += (accFixed[i] - (m_restAccLp[i] >> 30)) * m_kRestAcc;
+		int32_t deviation = clamp(accFixed[i] - (m_restAccLp[i] >> 30), One);
+		deviationSq += int64_t(deviation) * deviation;
+	}
+	if (deviationSq >= m_restThAccSq) {
+		m_restT = 0;
+		m_restDetected = false;
+	}
+
+	int32_t accUnit[3];
+	if (!normalize(accFixed, accUnit)) {
+		return;
+	}
+	int32_t gravity[3];
+	gravityEstimate(gravity);
+	cross(accUnit, gravity, m_accError);
+
+	for (int i = 0; i < 3; i++) {
+		m_integral[i]
+			= clamp(m_integral[i] + mulQ30(m_kiAccTs, m_accError[i]), m_biasClip);
+	}
+}
+
+void FixedPointFusion::updateMag(const sensor_real_t mag[3]) {
+	if (mag[0] == sensor_real_t(0.0) && mag[1] == sensor_real_t(0.0)
+		&& mag[2] == sensor_real_t(0.0)) {
+		return;
+	}
+
+	int32_t magFixed[3];
+	for (int i = 0; i < 3; i++) {
+		magFixed[i] = toFixed(mag[i], MagShift);
+	}
+	int32_t m[3];
+	if (!normalize(magFixed, m)) {
+		return;
+	}
+
+	// Rotation matrix from the sensor to the earth frame
+	int64_t q0 = m_quat[0], q1 = m_quat[1], q2 = m_quat[2], q3 = m_quat[3];
+	int64_t r[9] = {
+		int64_t(One) - ((q2 * q2 + q3 * q3) >> 29),
+		(q1 * q2 - q0 * q3) >> 29,
+		(q1 * q3 + q0 * q2) >> 29,
+		(q1 * q2 + q0 * q3) >> 29,
+		int64_t(One) - ((q1 * q1 + q3 * q3) >> 29),
+		(q2 * q3 - q0 * q1) >> 29,
+		(q1 * q3 - q0 * q2) >> 29,
+		(q2 * q3 + q0 * q1) >> 29,
+		int64_t(One) - ((q1 * q1 + q2 * q2) >> 29),
+	};
+
+	// Measured field in the earth frame, with the horizontal part rotated onto y,
+	// which points north in VQF's earth frame
+	int64_t h[3];
+	for (int i = 0; i < 3; i++) {
+		h[i] = (r[3 * i] * m[0] + r[3 * i + 1] * m[1] + r[3 * i + 2] * m[2]) >> 30;
+	}
+	int64_t bx = isqrt64(static_cast<uint64_t>(h[0] * h[0] + h[1] * h[1]));
+	int64_t bz = h[2];
+
+	// Expected field direction back in the sensor frame
+	int32_t expected[3];
+	for (int i = 0; i < 3; i++) {
+		expected[i] = static_cast<int32_t>((r[3 + i] * bx + r[6 + i] * bz) >> 30);
+	}
+	cross(m, expected, m_magError);
+}
+
+void FixedPointFusion::getQuat6D(sensor_real_t out[4]) const {
+	for (int i = 0; i < 4; i++) {
+		out[i] = m_quat[i] * (sensor_real_t(1) / One);
+	}
+}
+
+void FixedPointFusion::getQuat9D(sensor_real_t out[4]) const { getQuat6D(out); }
+
+void FixedPointFusion::getGravity(sensor_real_t out[3]) const {
+	int32_t gravity[3];
+	gravityEstimate(gravity);
+	for (int i = 0; i < 3; i++) {
+		out[i] = gravity[i] * (sensor_real_t(1) / One);
+	}
+}
+
+void FixedPointFusion::gravityEstimate(int32_t out[3]) const {
+	int64_t q0 = m_quat[0], q1 = m_quat[1], q2 = m_quat[2], q3 = m_quat[3];
+	out[0] = static_cast<int32_t>((q1 * q3 - q0 * q2) >> 29);
+	out[1] = static_cast<int32_t>((q0 * q1 + q2 * q3) >> 29);
+	out[2] = static_cast<int32_t>((q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) >> 30);
+}
+
+void FixedPointFusion::updateRestDetection(const int32_t rate[3], int32_t dtQ20) {
+	if (!m_restGyrLpReady) {
+		for (int i = 0; i < 3; i++) {
+			m_restGyrLp[i] = int64_t(rate[i]) << 30;
+		}
+		m_restGyrLpReady = true;
+	}
+
+	int64_t deviationSq = 0;
+	bool clipped = false;
+	for (int i = 0; i < 3; i++) {
+		m_restGyrLp[i] += (rate[i] - (m_restGyrLp[i] >> 30)) * m_kRestGyr;
+		int32_t lp = static_cast<int32_t>(m_restGyrLp[i] >> 30);
+		int32_t deviation = clamp(rate[i] - lp, One);
+		deviationSq += int64_t(deviation) * deviation;
+		clipped |= lp > (m_biasClip >> 10) || lp < -(m_biasClip >> 10);
+	}
+
+	if (deviationSq >= m_restThGyrSq || clipped) {
+		m_restT = 0;
+		m_restDetected = false;
+		return;
+	}
+
+	if (m_restT < m_restMinT) {
+		m_restT += dtQ20;
+		m_restDetected = m_restT >= m_restMinT;
+	}
+	if (m_restDetected && m_params.restBiasEstEnabled) {
+		for (int i = 0; i < 3; i++) {
+			m_bias[i] = static_cast<int32_t>(m_restGyrLp[i] >> 30);
+		}
+	}
+}
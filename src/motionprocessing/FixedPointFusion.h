@@ -0,0 +1,107 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#ifndef FIXED_POINT_FUSION_H
+#define FIXED_POINT_FUSION_H
+
+#include <vqf.h>
+
+#include <cstdint>
+
+#include "types.h"
+
+// Mahony-style complementary filter that runs in Q-format integers, for chips without
+// an FPU. Samples arrive as floats from the calibrator and are converted once on
+// entry; the gyro integration, quaternion normalization, accel/mag correction and rest
+// detection then run on int32/int64 only.
+//
+// Tuning is taken from VQFParams so the same per-IMU parameters work with either
+// backend: tauAcc/tauMag set the correction time constants, and the rest detection
+// and bias clipping parameters mean the same as in VQF.
+//
+// Unlike VQF, the magnetometer correction is folded into the same quaternion, so
+// getQuat6D() only stays magnetometer-free if updateMag() is never called.
+class FixedPointFusion {
+public:
+	FixedPointFusion(
+		const VQFParams& params,
+		sensor_real_t gyrTs,
+		sensor_real_t accTs = -1.0,
+		sensor_real_t magTs = -1.0
+	);
+
+	void updateGyr(const sensor_real_t gyr[3], sensor_real_t gyrTs);
+	void updateAcc(const sensor_real_t acc[3]);
+	void updateMag(const sensor_real_t mag[3]);
+
+	void getQuat6D(sensor_real_t out[4]) const;
+	void getQuat9D(sensor_real_t out[4]) const;
+	void getGravity(sensor_real_t out[3]) const;
+	bool getRestDetected() const { return m_restDetected; }
+
+	// Bias is tracked by the rest estimate and the correction integral, neither of
+	// which has a forgetting time
+	void updateBiasForgettingTime(float biasForgettingTime) {}
+
+	void resetState();
+
+private:
+	// Quaternion components and unit vectors
+	static constexpr int QuatShift = 30;
+	// Angular rates in rad/s
+	static constexpr int RateShift = 20;
+	// Acceleration in m/s^2
+	static constexpr int AccShift = 16;
+	// Magnetometer readings, in whatever unit the sensor reports
+	static constexpr int MagShift = 8;
+
+	void gravityEstimate(int32_t out[3]) const;
+	void updateRestDetection(const int32_t rate[3], int32_t dtQ20);
+
+	VQFParams m_params;
+
+	int32_t m_kp;  // Q30, 1/tauAcc
+	int32_t m_kpMag;  // Q30, 1/tauMag
+	int32_t m_kiAccTs;  // Q30, integral gain times accTs
+	int32_t m_kRestGyr;  // Q30, rest detection low-pass gain at gyrTs
+	int32_t m_kRestAcc;  // Q30, rest detection low-pass gain at accTs
+	int32_t m_biasClip;  // Q30 rad/s
+	int64_t m_restThGyrSq;  // Q40 (rad/s)^2
+	int64_t m_restThAccSq;  // Q32 (m/s^2)^2
+	int32_t m_restMinT;  // Q20 s
+
+	int32_t m_quat[4];  // Q30, w x y z
+	int32_t m_accError[3];  // Q30
+	int32_t m_magError[3];  // Q30
+	int32_t m_integral[3];  // Q30 rad/s
+	int32_t m_bias[3];  // Q20 rad/s
+
+	int64_t m_restGyrLp[3];  // Q50 rad/s
+	int64_t m_restAccLp[3];  // Q46 m/s^2
+	bool m_restGyrLpReady;
+	bool m_restAccLpReady;
+	int32_t m_restT;  // Q20 s
+	bool m_restDetected;
+};
+
+#endif
@@ -55,26 +55,22 @@ public:
 	}
 
 #ifndef REST_DETECTION_DISABLE_LPF
-	void filterInitialState(
-		sensor_real_t x0,
-		const double b[3],
-		const double a[2],
-		double out[]
-	) {
-		// initial state for steady state (equivalent to scipy.signal.lfilter_zi,
-		// obtained by setting y=x=x0 in the filter update equation)
-		out[0] = x0 * (1 - b[0]);
-		out[1] = x0 * (b[2] - a[1]);
+	void filterInitialState(sensor_real_t x0, sensor_real_t out[]) {
+		// steady state: the band-pass integrator is empty and the low-pass integrator
+		// holds the input
+		out[0] = 0;
+		out[1] = x0;
 	}
 
 	sensor_real_t
-	filterStep(sensor_real_t x, const double b[3], const double a[2], double state[2]) {
-		// difference equations based on scipy.signal.lfilter documentation
-		// assumes that a0 == 1.0
-		double y = b[0] * x + state[0];
-		state[0] = b[1] * x - a[0] * y + state[1];
-		state[1] = b[2] * x - a[1] * y;
-		return y;
+	filterStep(sensor_real_t x, const sensor_real_t c[3], sensor_real_t state[2]) {
+		// trapezoidal state-variable filter, see VQF::filterStep()
+		sensor_real_t v3 = x - state[1];
+		sensor_real_t v1 = c[0] * state[0] + c[1] * v3;
+		sensor_real_t v2 = state[1] + c[1] * state[0] + c[2] * v3;
+		state[0] = 2 * v1 - state[0];
+		state[1] = 2 * v2 - state[1];
+		return v2;
 	}
 
 	void filterVec(
@@ -82,9 +78,8 @@ public:
 		size_t N,
 		sensor_real_t tau,
 		sensor_real_t Ts,
-		const double b[3],
-		const double a[2],
-		double state[],
+		const sensor_real_t c[3],
+		sensor_real_t state[],
 		sensor_real_t out[]
 	) {
 		assert(N >= 2);
@@ -105,14 +100,14 @@ public:
 			}
 			if (state[1] * Ts >= tau) {
 				for (size_t i = 0; i < N; i++) {
-					filterInitialState(out[i], b, a, state + 2 * i);
+					filterInitialState(out[i], state + 2 * i);
 				}
 			}
 			return;
 		}
 
 		for (size_t i = 0; i < N; i++) {
-			out[i] = filterStep(x[i], b, a, state + 2 * i);
+			out[i] = filterStep(x[i], c, state + 2 * i);
 		}
 	}
 #endif
@@ -141,8 +136,7 @@ public:
 			3,
 			params.restFilterTau,
 			gyrTs,
-			restGyrLpB,
-			restGyrLpA,
+			restGyrLpCoeffs,
 			restGyrLpState,
 			restLastGyrLp
 		);
@@ -192,8 +186,7 @@ public:
 			3,
 			params.restFilterTau,
 			accTs,
-			restAccLpB,
-			restAccLpA,
+			restAccLpCoeffs,
 			restAccLpState,
 			restLastAccLp
 		);
@@ -214,7 +207,7 @@ public:
 #endif
 	}
 
-	bool getRestDetected() { return restDetected; }
+	bool getRestDetected() const { return restDetected; }
 
 #ifndef REST_DETECTION_DISABLE_LPF
 	void resetState() {
@@ -229,24 +222,19 @@ public:
 		std::fill(restAccLpState, restAccLpState + 3 * 2, NaN);
 	}
 
-	void
-	filterCoeffs(sensor_real_t tau, sensor_real_t Ts, double outB[], double outA[]) {
+	void filterCoeffs(sensor_real_t tau, sensor_real_t Ts, sensor_real_t out[]) {
 		assert(tau > 0);
 		assert(Ts > 0);
-		// second order Butterworth filter based on https://stackoverflow.com/a/52764064
-		double fc
+		// second order Butterworth filter as a state-variable filter, see
+		// VQF::filterCoeffs()
+		sensor_real_t fc
 			= (M_SQRT2 / (2.0 * M_PI))
-			/ double(tau
-			);  // time constant of dampened, non-oscillating part of step response
-		double C = tan(M_PI * fc * double(Ts));
-		double D = C * C + sqrt(2) * C + 1;
-		double b0 = C * C / D;
-		outB[0] = b0;
-		outB[1] = 2 * b0;
-		outB[2] = b0;
-		// a0 = 1.0
-		outA[0] = 2 * (C * C - 1) / D;  // a1
-		outA[1] = (1 - sqrt(2) * C + C * C) / D;  // a2
+			/ tau;  // time constant of dampened, non-oscillating part of step response
+		sensor_real_t g = tan(M_PI * fc * Ts);
+		sensor_real_t c1 = 1 / (1 + g * (g + sensor_real_t(M_SQRT2)));
+		out[0] = c1;
+		out[1] = g * c1;
+		out[2] = g * g * c1;
 	}
 #endif
 
@@ -255,8 +243,8 @@ public:
 		assert(gyrTs > 0);
 		assert(accTs > 0);
 
-		filterCoeffs(params.restFilterTau, gyrTs, restGyrLpB, restGyrLpA);
-		filterCoeffs(params.restFilterTau, accTs, restAccLpB, restAccLpA);
+		filterCoeffs(params.restFilterTau, gyrTs, restGyrLpCoeffs);
+		filterCoeffs(params.restFilterTau, accTs, restAccLpCoeffs);
 
 		resetState();
 #endif
@@ -273,13 +261,11 @@ private:
 	sensor_real_t accTs;
 #ifndef REST_DETECTION_DISABLE_LPF
 	sensor_real_t restLastGyrLp[3];
-	double restGyrLpState[3 * 2];
-	double restGyrLpB[3];
-	double restGyrLpA[2];
+	sensor_real_t restGyrLpState[3 * 2];
+	sensor_real_t restGyrLpCoeffs[3];
 	sensor_real_t restLastAccLp[3];
-	double restAccLpState[3 * 2];
-	double restAccLpB[3];
-	double restAccLpA[2];
+	sensor_real_t restAccLpState[3 * 2];
+	sensor_real_t restAccLpCoeffs[3];
 #else
 	struct {
 		float gyr[3];
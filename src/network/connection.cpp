@@ -789,6 +789,8 @@ void Connection::update() {
             uint8_t sensorId = setConfigFlagPacket.sensorId;
             SensorToggles flag = setConfigFlagPacket.flag;
             bool newState = setConfigFlagPacket.newState;
+            // Toggling a flag can reconfigure the sensor over its bus
+            auto sensorLock = sensorManager.lockSensors();
             if (sensorId == UINT8_MAX) {
                 for (auto& sensor : sensors) {
                     sensor->setFlag(flag, newState);
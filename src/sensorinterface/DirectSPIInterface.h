@@ -26,6 +26,8 @@
 #include <PinInterface.h>
 #include <SPI.h>
 
+#include <cstring>
+
 #include "SensorInterface.h"
 
 namespace SlimeVR {
@@ -46,6 +48,17 @@ public:
 		return m_spiClass.transfer(args...);
 	}
 
+	// Clocks a whole buffer through the SPI peripheral's FIFO instead of going
+	// byte by byte. Reads are done in place, the buffer is sent out as dummy bytes.
+	void readBuffer(uint8_t* buffer, size_t size) {
+		std::memset(buffer, 0, size);
+		m_spiClass.transfer(buffer, size);
+	}
+
+	void writeBuffer(const uint8_t* buffer, size_t size) {
+		m_spiClass.writeBytes(buffer, size);
+	}
+
 	const SPISettings& getSpiSettings();
 
 private:
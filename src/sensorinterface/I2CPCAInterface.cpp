@@ -22,6 +22,15 @@
 */
 #include "I2CPCAInterface.h"
 
+#include <map>
+#include <tuple>
+
+namespace {
+// The channel each mux (by bus pins and address) was last switched to, so that
+// sensors behind the same channel swap in without another mux transaction
+std::map<std::tuple<uint8_t, uint8_t, uint8_t>, uint8_t> activeMuxChannels;
+}  // namespace
+
 bool SlimeVR::I2CPCASensorInterface::init() {
 	m_Wire.init();
 	return true;
@@ -29,9 +38,21 @@ bool SlimeVR::I2CPCASensorInterface::init() {
 
 void SlimeVR::I2CPCASensorInterface::swapIn() {
 	m_Wire.swapIn();
+
+	const auto mux = std::make_tuple(m_Wire.getSclPin(), m_Wire.getSdaPin(), m_Address);
+	const auto activeChannel = activeMuxChannels.find(mux);
+	if (activeChannel != activeMuxChannels.end()
+		&& activeChannel->second == m_Channel) {
+		return;
+	}
+
 	Wire.beginTransmission(m_Address);
 	Wire.write(1 << m_Channel);
-	Wire.endTransmission();
+	if (Wire.endTransmission() == 0) {
+		activeMuxChannels[mux] = m_Channel;
+	} else {
+		activeMuxChannels.erase(mux);
+	}
 #ifdef ESP32
 	// On ESP32 we need to reconnect to I2C bus for some reason
 	m_Wire.disconnect();
@@ -45,6 +45,9 @@ public:
 
 	bool init() override final;
 	void swapIn() override final;
+	[[nodiscard]] bool isI2C() const final { return true; }
+	// PCA9547 and PCA9546A are Fast-mode parts
+	[[nodiscard]] uint32_t getMaxI2CClock() const final { return 400000; }
 
 	[[nodiscard]] std::string toString() const final {
 		using namespace std::string_literals;
@@ -0,0 +1,102 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#include "I2CReadQueue.h"
+
+#include "I2CWireSensorInterface.h"
+#include "I2Cdev.h"
+
+namespace SlimeVR::Sensors {
+
+I2CReadQueue I2CReadQueue::instance;
+
+#ifdef ESP32
+
+void I2CReadQueue::start() {
+	m_reads = xQueueCreate(MaxQueuedReads, sizeof(Read));
+	m_done = xSemaphoreCreateBinary();
+	xTaskCreate(taskMain, "i2c_reads", TaskStackSize, this, TaskPriority, nullptr);
+}
+
+void I2CReadQueue::taskMain(void* self) {
+	auto& queue = *static_cast<I2CReadQueue*>(self);
+	Read read;
+	while (true) {
+		xQueueReceive(queue.m_reads, &read, portMAX_DELAY);
+		if (I2Cdev::readBytes(read.devAddr, read.regAddr, read.size, read.buffer)
+			!= read.size) {
+			queue.m_errors++;
+		}
+		if (--queue.m_pending == 0) {
+			xSemaphoreGive(queue.m_done);
+		}
+	}
+}
+
+void I2CReadQueue::push(
+	uint8_t devAddr,
+	uint8_t regAddr,
+	uint8_t size,
+	uint8_t* buffer
+) {
+	if (m_reads == nullptr) {
+		start();
+	}
+
+	m_pending++;
+	const Read read{devAddr, regAddr, size, buffer};
+	// blocks while the queue is full, which only costs some of the overlap
+	xQueueSend(m_reads, &read, portMAX_DELAY);
+}
+
+void I2CReadQueue::wait() {
+	// the semaphore may still be given from an earlier batch, so check again after
+	// every take
+	while (m_pending > 0) {
+		xSemaphoreTake(m_done, portMAX_DELAY);
+	}
+
+	// reported from here, the bus state isn't meant to be touched from other tasks
+	if (const auto errors = m_errors.exchange(0)) {
+		reportI2CErrors(errors);
+	}
+}
+
+#else
+
+void I2CReadQueue::push(
+	uint8_t devAddr,
+	uint8_t regAddr,
+	uint8_t size,
+	uint8_t* buffer
+) {
+	if (I2Cdev::readBytes(devAddr, regAddr, size, buffer) != size) {
+		reportI2CErrors();
+	}
+}
+
+void I2CReadQueue::wait() {}
+
+#endif
+
+}  // namespace SlimeVR::Sensors
@@ -0,0 +1,75 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#endif
+
+namespace SlimeVR::Sensors {
+
+// Hands I2C register reads to a separate task, so the caller can go on with other
+// work while the transfer is running. The ESP32 I2C driver sleeps until the
+// peripheral is done, which leaves the CPU free even on single core chips. Nothing
+// else may touch the bus until wait() returned, and the buffers have to stay alive
+// until then too. Without FreeRTOS the reads are done right away.
+class I2CReadQueue {
+public:
+	void push(uint8_t devAddr, uint8_t regAddr, uint8_t size, uint8_t* buffer);
+	void wait();
+
+	static I2CReadQueue instance;
+
+#ifdef ESP32
+private:
+	struct Read {
+		uint8_t devAddr;
+		uint8_t regAddr;
+		uint8_t size;
+		uint8_t* buffer;
+	};
+
+	static constexpr size_t MaxQueuedReads = 32;
+	static constexpr uint32_t TaskStackSize = 2048;
+	// Above the loop task, so the next read is issued as soon as the last one is done
+	static constexpr UBaseType_t TaskPriority = 2;
+
+	void start();
+	static void taskMain(void* self);
+
+	QueueHandle_t m_reads = nullptr;
+	SemaphoreHandle_t m_done = nullptr;
+	std::atomic<uint8_t> m_pending{0};
+	std::atomic<uint32_t> m_errors{0};
+#endif
+};
+
+}  // namespace SlimeVR::Sensors
@@ -23,12 +23,33 @@
 
 #include "I2CWireSensorInterface.h"
 
+#include <map>
 #include <optional>
 
+#include "logging/Logger.h"
+
 std::optional<uint8_t> activeSCLPin;
 std::optional<uint8_t> activeSDAPin;
 bool isI2CActive = false;
 
+namespace {
+struct I2CBusState {
+	uint32_t clock = I2C_SPEED;
+	uint32_t errorWindowStartMillis = 0;
+	uint32_t errors = 0;
+};
+
+// Slowest clock the bus falls back to when reads keep failing
+constexpr uint32_t I2CStandardModeClock = 100000;
+constexpr uint32_t I2CErrorWindowMillis = 1000;
+constexpr uint32_t I2CMaxErrorsPerWindow = 10;
+
+std::map<SlimeVR::I2CBus, I2CBusState> busStates;
+// Sensor detection reads from addresses nothing answers on, only count errors after
+bool trackI2CErrors = false;
+SlimeVR::Logging::Logger i2cLogger("I2C");
+}  // namespace
+
 namespace SlimeVR {
 void swapI2C(uint8_t sclPin, uint8_t sdaPin) {
 	if (sclPin != activeSCLPin || sdaPin != activeSDAPin || !isI2CActive) {
@@ -45,16 +66,18 @@ void swapI2C(uint8_t sclPin, uint8_t sdaPin) {
 			gpio_set_direction((gpio_num_t)*activeSDAPin, GPIO_MODE_INPUT);
 		}
 
+		const uint32_t clock = busStates[{sclPin, sdaPin}].clock;
 		if (isI2CActive) {
 			Wire.end();
-			Wire.begin(static_cast<int>(sdaPin), static_cast<int>(sclPin), I2C_SPEED);
+			Wire.begin(static_cast<int>(sdaPin), static_cast<int>(sclPin), clock);
 			Wire.setTimeOut(150);
 		} else {
-			Wire.begin(static_cast<int>(sdaPin), static_cast<int>(sclPin), I2C_SPEED);
+			Wire.begin(static_cast<int>(sdaPin), static_cast<int>(sclPin), clock);
 			Wire.setTimeOut(150);
 		}
 #else
 		Wire.begin(static_cast<int>(sdaPin), static_cast<int>(sclPin));
+		Wire.setClock(busStates[{sclPin, sdaPin}].clock);
 #endif
 
 		activeSCLPin = sclPin;
@@ -63,6 +86,63 @@ void swapI2C(uint8_t sclPin, uint8_t sdaPin) {
 	}
 }
 
+std::optional<I2CBus> getActiveI2CBus() {
+	if (!isI2CActive || !activeSCLPin || !activeSDAPin) {
+		return std::nullopt;
+	}
+	return I2CBus{*activeSCLPin, *activeSDAPin};
+}
+
+uint32_t getI2CClock(I2CBus bus) { return busStates[bus].clock; }
+
+void setI2CClock(I2CBus bus, uint32_t clock) {
+	auto& state = busStates[bus];
+	state.clock = clock;
+	state.errors = 0;
+	if (getActiveI2CBus() == bus) {
+		Wire.setClock(clock);
+	}
+}
+
+uint32_t getMaxWireClock() {
+#ifdef ESP8266
+	// twi_setClock() limits the clock depending on the CPU frequency
+	return F_CPU == 80000000L ? 400000 : 800000;
+#else
+	return UINT32_MAX;
+#endif
+}
+
+void startI2CErrorTracking() { trackI2CErrors = true; }
+
+void reportI2CErrors(uint32_t count) {
+	const auto bus = getActiveI2CBus();
+	if (!trackI2CErrors || !bus) {
+		return;
+	}
+
+	auto& state = busStates[*bus];
+	const uint32_t now = millis();
+	if (now - state.errorWindowStartMillis >= I2CErrorWindowMillis) {
+		state.errorWindowStartMillis = now;
+		state.errors = 0;
+	}
+
+	state.errors += count;
+	if (state.errors < I2CMaxErrorsPerWindow || state.clock <= I2CStandardModeClock) {
+		return;
+	}
+
+	const uint32_t clock = state.clock > I2C_SPEED ? I2C_SPEED : I2CStandardModeClock;
+	i2cLogger.warn(
+		"Too many errors on I2C bus (SCL %d, SDA %d), lowering clock to %d kHz",
+		bus->first,
+		bus->second,
+		clock / 1000
+	);
+	setI2CClock(*bus, clock);
+}
+
 void disconnectI2C() {
 	Wire.flush();
 	isI2CActive = false;
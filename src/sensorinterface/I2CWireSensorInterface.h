@@ -27,13 +27,31 @@
 #include <Arduino.h>
 #include <i2cscan.h>
 
+#include <optional>
+#include <utility>
+
 #include "SensorInterface.h"
 #include "globals.h"
 
 namespace SlimeVR {
+// SCL and SDA pin
+using I2CBus = std::pair<uint8_t, uint8_t>;
+
 void swapI2C(uint8_t sclPin, uint8_t sdaPin);
 void disconnectI2C();
 
+std::optional<I2CBus> getActiveI2CBus();
+// Each bus runs at I2C_SPEED unless set otherwise, changes apply right away if the
+// bus is active
+uint32_t getI2CClock(I2CBus bus);
+void setI2CClock(I2CBus bus, uint32_t clock);
+// Fastest clock Wire really runs at, it silently clamps faster ones
+uint32_t getMaxWireClock();
+// Failed reads on the active bus. Once tracking started, the bus clock is stepped
+// down if they pile up
+void startI2CErrorTracking();
+void reportI2CErrors(uint32_t count = 1);
+
 /**
  * I2C Sensor interface using direct arduino Wire on provided pins
  *
@@ -47,7 +65,10 @@ public:
 
 	bool init() override final { return true; }
 	void swapIn() override final { swapI2C(_sclPin, _sdaPin); }
+	[[nodiscard]] bool isI2C() const final { return true; }
 	void disconnect() { disconnectI2C(); }
+	[[nodiscard]] uint8_t getSclPin() const { return _sclPin; }
+	[[nodiscard]] uint8_t getSdaPin() const { return _sdaPin; }
 
 	[[nodiscard]] std::string toString() const final {
 		using namespace std::string_literals;
@@ -37,6 +37,18 @@ struct RegisterInterface {
 	virtual void writeReg16(uint8_t regAddr, uint16_t value) const = 0;
 	virtual void readBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const = 0;
 	virtual void writeBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const = 0;
+	// Split readBytes(): the read may still be running when startReadBytes() returns,
+	// the buffer is only filled and the bus only free again after finishReads(), which
+	// waits for all reads started on the bus. Interfaces that can't read in the
+	// background read right away.
+	virtual void startReadBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const {
+		readBytes(regAddr, size, buffer);
+	}
+	virtual void finishReads() const {}
+	// Longest readBytes/writeBytes the bus can do in one go
+	[[nodiscard]] virtual size_t getMaxTransactionLength() const {
+		return MaxTransactionLength;
+	}
 	[[nodiscard]] virtual uint8_t getAddress() const = 0;
 	virtual bool hasSensorOnBus() = 0;
 	[[nodiscard]] virtual std::string toString() const = 0;
@@ -95,9 +95,7 @@ struct SPIImpl : public RegisterInterface {
 		m_spi->beginTransaction(m_csPin);
 
 		m_spi->transfer(regAddr | ICM_READ_FLAG);
-		for (uint8_t i = 0; i < size; ++i) {
-			buffer[i] = m_spi->transfer(0);
-		}
+		m_spi->readBuffer(buffer, size);
 
 		m_spi->endTransaction(m_csPin);
 	}
@@ -106,9 +104,7 @@ struct SPIImpl : public RegisterInterface {
 		m_spi->beginTransaction(m_csPin);
 
 		m_spi->transfer(regAddr);
-		for (uint8_t i = 0; i < size; ++i) {
-			m_spi->transfer(buffer[i]);
-		}
+		m_spi->writeBuffer(buffer, size);
 
 		m_spi->endTransaction(m_csPin);
 	}
@@ -117,6 +113,9 @@ struct SPIImpl : public RegisterInterface {
 		return true;  // TODO
 	}
 
+	// no bus buffer to fit into, only the size parameter limits transfers
+	size_t getMaxTransactionLength() const override { return 0xff; }
+
 	uint8_t getAddress() const override { return 0; }
 
 	std::string toString() const override { return std::string("SPI"); }
@@ -24,6 +24,7 @@
 #ifndef SENSORINTERFACE_H
 #define SENSORINTERFACE_H
 
+#include <cstdint>
 #include <string>
 
 namespace SlimeVR {
@@ -32,6 +33,10 @@ public:
 	virtual bool init() = 0;
 	virtual void swapIn() = 0;
 	[[nodiscard]] virtual std::string toString() const = 0;
+	// Whether swapIn() makes one of the Wire buses active
+	[[nodiscard]] virtual bool isI2C() const { return false; }
+	// Fastest I2C clock the interface itself can keep up with
+	[[nodiscard]] virtual uint32_t getMaxI2CClock() const { return UINT32_MAX; }
 };
 
 class EmptySensorInterface : public SensorInterface {
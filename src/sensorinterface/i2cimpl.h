@@ -27,6 +27,8 @@
 
 #include <cstdint>
 
+#include "I2CReadQueue.h"
+#include "I2CWireSensorInterface.h"
 #include "I2Cdev.h"
 #include "RegisterInterface.h"
 
@@ -38,18 +40,23 @@ struct I2CImpl : public RegisterInterface {
 
 	uint8_t readReg(uint8_t regAddr) const override {
 		uint8_t buffer = 0;
-		I2Cdev::readByte(m_devAddr, regAddr, &buffer);
+		if (I2Cdev::readByte(m_devAddr, regAddr, &buffer) != 1) {
+			reportI2CErrors();
+		}
 		return buffer;
 	}
 
 	uint16_t readReg16(uint8_t regAddr) const override {
 		uint16_t buffer = 0;
-		I2Cdev::readBytes(
+		const auto bytesRead = I2Cdev::readBytes(
 			m_devAddr,
 			regAddr,
 			sizeof(buffer),
 			reinterpret_cast<uint8_t*>(&buffer)
 		);
+		if (bytesRead != sizeof(buffer)) {
+			reportI2CErrors();
+		}
 		return buffer;
 	}
 
@@ -67,13 +74,22 @@ struct I2CImpl : public RegisterInterface {
 	}
 
 	void readBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const override {
-		I2Cdev::readBytes(m_devAddr, regAddr, size, buffer);
+		if (I2Cdev::readBytes(m_devAddr, regAddr, size, buffer) != size) {
+			reportI2CErrors();
+		}
 	}
 
 	void writeBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const override {
 		I2Cdev::writeBytes(m_devAddr, regAddr, size, buffer);
 	}
 
+	void startReadBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer)
+		const override {
+		I2CReadQueue::instance.push(m_devAddr, regAddr, size, buffer);
+	}
+
+	void finishReads() const override { I2CReadQueue::instance.wait(); }
+
 	bool hasSensorOnBus() {
 		// Ask twice, because we're nice like this
 		return I2CSCAN::hasDevOnBus(m_devAddr) || I2CSCAN::hasDevOnBus(m_devAddr);
@@ -37,7 +37,7 @@ void ADCResistanceSensor::motionLoop() {
 #endif
 }
 
-void ADCResistanceSensor::sendData() {
+void ADCResistanceSensor::sendAuxiliaryData() {
 	networkConnection.sendFlexData(sensorId, m_Data);
 }
 
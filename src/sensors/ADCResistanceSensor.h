@@ -52,7 +52,7 @@ public:
 	~ADCResistanceSensor();
 
 	void motionLoop() override final;
-	void sendData() override final;
+	void sendAuxiliaryData() override final;
 
 	SensorStatus getSensorState() override final { return SensorStatus::SENSOR_OK; }
 
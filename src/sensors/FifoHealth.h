@@ -0,0 +1,57 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace SlimeVR::Sensors {
+
+// Counters of the data lost between an IMU's FIFO and the host, kept by the drivers
+// and printed with the sensor info
+struct FifoHealth {
+	uint32_t overruns = 0;  // FIFO filled up and dropped samples
+	uint32_t invalidFrames = 0;  // frames with a bad header or invalid sample values
+	uint32_t skippedFrames = 0;  // frames the sensor reported as skipped
+	uint32_t discardedBytes = 0;  // bytes read but thrown away
+	uint32_t recoveries = 0;  // times the FIFO was flushed to recover from corruption
+	uint32_t pendingBytes = 0;  // bytes waiting in the FIFO at the last read
+	uint32_t peakBytes = 0;  // highest backlog seen since startup
+	uint32_t deferredReads = 0;  // loops cut short to stay in the time budget
+
+	void recordFillLevel(size_t bytes) {
+		pendingBytes = static_cast<uint32_t>(bytes);
+		peakBytes = std::max(peakBytes, pendingBytes);
+	}
+
+	// The rest of the read is unusable, the driver flushes the FIFO after this
+	void recordCorruption(size_t bytesLeft) {
+		invalidFrames++;
+		discardedBytes += bytesLeft;
+		recoveries++;
+	}
+};
+
+}  // namespace SlimeVR::Sensors
@@ -0,0 +1,62 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <cstdint>
+
+namespace SlimeVR::Sensors {
+
+// Caps how many reports a sensor handles in one motionLoop(), by count and by time,
+// so a burst from one IMU can't hold up the rest of the loop. Reports over the
+// budget stay in the IMU until the next loop.
+class LoopBudget {
+public:
+	constexpr LoopBudget(uint32_t maxMicros, uint32_t maxReports)
+		: m_maxMicros(maxMicros)
+		, m_maxReports(maxReports) {}
+
+	void start() {
+		m_startMicros = micros();
+		m_reports = 0;
+	}
+
+	// Whether there's budget left for another report
+	bool take() {
+		if (m_reports >= m_maxReports || micros() - m_startMicros >= m_maxMicros) {
+			return false;
+		}
+		m_reports++;
+		return true;
+	}
+
+private:
+	uint32_t m_maxMicros;
+	uint32_t m_maxReports;
+	uint32_t m_startMicros = 0;
+	uint32_t m_reports = 0;
+};
+
+}  // namespace SlimeVR::Sensors
@@ -23,16 +23,16 @@
 
 #include "RestCalibrationDetector.h"
 
-#include "sensors/SensorFusion.h"
+#include <Arduino.h>
 
 namespace SlimeVR::Sensors {
 
-bool RestCalibrationDetector::update(SensorFusion& fusion) {
+bool RestCalibrationDetector::update(bool restDetected) {
 	if (state == CalibrationState::Done) {
 		return false;
 	}
 
-	if (!fusion.getRestDetected()) {
+	if (!restDetected) {
 		state = CalibrationState::NoRest;
 		return false;
 	}
@@ -25,13 +25,11 @@
 
 #include <cstdint>
 
-#include "sensors/SensorFusion.h"
-
 namespace SlimeVR::Sensors {
 
 class RestCalibrationDetector {
 public:
-	bool update(SensorFusion& fusion);
+	bool update(bool restDetected);
 
 private:
 	static constexpr float restCalibrationSeconds = 3.0f;
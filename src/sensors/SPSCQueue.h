@@ -0,0 +1,109 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace SlimeVR {
+
+// Lock-free queue between exactly one producer and one consumer, which may run on
+// different cores. The producer only writes the tail, the acquire/release pairs make
+// sure an element is completely written before the other side sees it. The head is
+// the consumer's, except when pushOverwrite() evicts, both sides move it with a CAS.
+template <typename T, size_t Capacity>
+class SPSCQueue {
+	static_assert(
+		Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+		"Capacity has to be a power of two"
+	);
+
+public:
+	// Returns false if the queue is full, the element is dropped then
+	bool push(const T& element) {
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+
+		m_elements[tail & (Capacity - 1)] = element;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Like push(), but a full queue evicts its oldest element to make room instead.
+	// Returns false if an element was evicted
+	bool pushOverwrite(const T& element) {
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		size_t head = m_head.load(std::memory_order_acquire);
+		bool evicted = false;
+		if (tail - head == Capacity) {
+			// Fails if the consumer took the oldest element in the meantime, that makes
+			// room just the same
+			evicted = m_head.compare_exchange_strong(
+				head,
+				head + 1,
+				std::memory_order_acq_rel
+			);
+		}
+
+		m_elements[tail & (Capacity - 1)] = element;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return !evicted;
+	}
+
+	// Returns false if the queue is empty
+	bool pop(T& element) {
+		size_t head = m_head.load(std::memory_order_acquire);
+		do {
+			if (head == m_tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+			element = m_elements[head & (Capacity - 1)];
+			// pushOverwrite() moves the head as well. If it did while the element was
+			// copied, the copy may be half overwritten and is thrown away
+		} while (!m_head.compare_exchange_weak(
+			head,
+			head + 1,
+			std::memory_order_acq_rel,
+			std::memory_order_acquire
+		));
+		return true;
+	}
+
+	// Only a snapshot, the other side may change it right after
+	[[nodiscard]] bool empty() const {
+		return m_head.load(std::memory_order_acquire)
+			== m_tail.load(std::memory_order_acquire);
+	}
+
+private:
+	std::array<T, Capacity> m_elements{};
+	// Both only ever count up, the difference is the amount of queued elements
+	std::atomic<size_t> m_head{0};
+	std::atomic<size_t> m_tail{0};
+};
+
+}  // namespace SlimeVR
@@ -28,8 +28,8 @@ namespace SlimeVR::Sensors {
 SensorBuilder::SensorBuilder(SensorManager* sensorManager)
 	: m_Manager(sensorManager) {}
 
-#define SENSOR_DESC_ENTRY(ImuType, ...)                                           \
-	activeSensorCount += sensorDescEntry<ImuType>(sensorID, __VA_ARGS__) ? 1 : 0; \
+#define SENSOR_DESC_ENTRY(ImuType, ...)             \
+	sensorDescEntry<ImuType>(sensorID, __VA_ARGS__); \
 	sensorID++;
 
 #define SENSOR_INFO_ENTRY(ImuID, SensorPosition) \
@@ -66,12 +66,41 @@ uint8_t SensorBuilder::buildAllSensors() {
 	// Apply descriptor list and expand to entries
 	SENSOR_DESC_LIST
 
+	setupSensors();
+
+	for (auto& sensor : m_Manager->m_Sensors) {
+		if (sensor->isWorking()) {
+			m_Manager->m_Logger.info("Sensor %d configured", sensor->getSensorId());
+			activeSensorCount++;
+		}
+	}
+
 	// Apply sensor info list and expand to entries
 	SENSOR_INFO_LIST
 
 	return activeSensorCount;
 }
 
+// Steps through the setup of all sensors at once, so their reset times overlap
+// instead of adding up
+void SensorBuilder::setupSensors() {
+	while (!m_PendingSetup.empty()) {
+		for (auto it = m_PendingSetup.begin(); it != m_PendingSetup.end();) {
+			auto* sensor = *it;
+			if (sensor->m_hwInterface != nullptr) {
+				sensor->m_hwInterface->swapIn();
+			}
+
+			if (sensor->motionSetupStep()) {
+				it = m_PendingSetup.erase(it);
+			} else {
+				++it;
+			}
+		}
+		yield();
+	}
+}
+
 std::unique_ptr<::Sensor>
 SensorBuilder::buildSensorDynamically(SensorTypeID type, SensorDefinition sensorDef) {
 	switch (type) {
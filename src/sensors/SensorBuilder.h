@@ -26,6 +26,7 @@
 #include <memory>
 #include <optional>
 #include <type_traits>
+#include <vector>
 
 #include "EmptySensor.h"
 #include "ErroneousSensor.h"
@@ -223,7 +224,7 @@ public:
 	}
 
 	template <typename SensorType, typename AccessInterface>
-	bool sensorDescEntry(
+	void sensorDescEntry(
 		uint8_t sensorID,
 		AccessInterface accessInterface,
 		float rotation,
@@ -241,7 +242,7 @@ public:
 					"Can't find sensor type for sensor %d",
 					sensorID
 				);
-				return false;
+				return;
 			}
 
 			auto sensorType = result->first;
@@ -282,15 +283,7 @@ public:
 			});
 		}
 
-		bool working = sensor->isWorking();
 		m_Manager->m_Sensors.push_back(std::move(sensor));
-
-		if (!working) {
-			return false;
-		}
-
-		m_Manager->m_Logger.info("Sensor %d configured", sensorID);
-		return true;
 	}
 
 	template <typename ImuType>
@@ -351,12 +344,16 @@ public:
 			sensorDef.extraParam
 		);
 
-		sensor->motionSetup();
+		m_PendingSetup.push_back(sensor.get());
 		return sensor;
 	}
 
 private:
+	void setupSensors();
+
 	SensorInterfaceManager interfaceManager;
+	// Detected sensors, set up together once all of them are built
+	std::vector<::Sensor*> m_PendingSetup;
 };
 
 }  // namespace SlimeVR::Sensors
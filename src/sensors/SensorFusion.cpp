@@ -2,7 +2,8 @@
 
 namespace SlimeVR::Sensors {
 
-void SensorFusion::update6D(
+template <typename Backend>
+void GenericSensorFusion<Backend>::update6D(
 	sensor_real_t Axyz[3],
 	sensor_real_t Gxyz[3],
 	sensor_real_t deltat
@@ -11,7 +12,8 @@ void SensorFusion::update6D(
 	updateGyro(Gxyz, deltat);
 }
 
-void SensorFusion::update9D(
+template <typename Backend>
+void GenericSensorFusion<Backend>::update9D(
 	sensor_real_t Axyz[3],
 	sensor_real_t Gxyz[3],
 	sensor_real_t Mxyz[3],
@@ -22,16 +24,25 @@ void SensorFusion::update9D(
 	updateGyro(Gxyz, deltat);
 }
 
-void SensorFusion::updateAcc(const sensor_real_t Axyz[3], sensor_real_t deltat) {
+template <typename Backend>
+void GenericSensorFusion<Backend>::updateAcc(
+	const sensor_real_t Axyz[3],
+	sensor_real_t deltat
+) {
 	if (deltat < 0) {
 		deltat = accTs;
 	}
 
 	std::copy(Axyz, Axyz + 3, bAxyz);
-	vqf.updateAcc(Axyz);
+	fusion.updateAcc(Axyz);
+	invalidateOutputs();
 }
 
-void SensorFusion::updateMag(const sensor_real_t Mxyz[3], sensor_real_t deltat) {
+template <typename Backend>
+void GenericSensorFusion<Backend>::updateMag(
+	const sensor_real_t Mxyz[3],
+	sensor_real_t deltat
+) {
 	if (deltat < 0) {
 		deltat = magTs;
 	}
@@ -44,49 +55,122 @@ void SensorFusion::updateMag(const sensor_real_t Mxyz[3], sensor_real_t deltat)
 		}
 	}
 
-	vqf.updateMag(Mxyz);
+	fusion.updateMag(Mxyz);
+	invalidateOutputs();
 }
 
-void SensorFusion::updateGyro(const sensor_real_t Gxyz[3], sensor_real_t deltat) {
+template <typename Backend>
+void GenericSensorFusion<Backend>::updateGyro(
+	const sensor_real_t Gxyz[3],
+	sensor_real_t deltat
+) {
 	if (deltat < 0) {
 		deltat = gyrTs;
 	}
 
-	vqf.updateGyr(Gxyz, deltat);
+	fusion.updateGyr(Gxyz, deltat);
 
 	updated = true;
+	invalidateOutputs();
+}
+
+template <typename Backend>
+void GenericSensorFusion<Backend>::updateBatch(
+	const sensor_real_t* const Gxyz[3],
+	const sensor_real_t Gdt[],
+	size_t gyroCount,
+	const sensor_real_t* const Axyz[3],
+	const sensor_real_t Adt[],
+	size_t accCount
+) {
+	size_t accIndex = 0;
+	sensor_real_t accTime = accCount > 0 ? Adt[0] : 0;
+	sensor_real_t gyroTime = 0;
+	for (size_t i = 0; i < gyroCount; i++) {
+		gyroTime += Gdt[i];
+		for (; accIndex < accCount && accTime <= gyroTime; accIndex++) {
+			const sensor_real_t acc[3]{
+				Axyz[0][accIndex],
+				Axyz[1][accIndex],
+				Axyz[2][accIndex],
+			};
+			fusion.updateAcc(acc);
+			if (accIndex + 1 < accCount) {
+				accTime += Adt[accIndex + 1];
+			}
+		}
+
+		const sensor_real_t gyro[3]{Gxyz[0][i], Gxyz[1][i], Gxyz[2][i]};
+		fusion.updateGyr(gyro, Gdt[i]);
+	}
+
+	for (; accIndex < accCount; accIndex++) {
+		const sensor_real_t acc[3]{
+			Axyz[0][accIndex],
+			Axyz[1][accIndex],
+			Axyz[2][accIndex],
+		};
+		fusion.updateAcc(acc);
+	}
+
+	if (accCount > 0) {
+		bAxyz[0] = Axyz[0][accCount - 1];
+		bAxyz[1] = Axyz[1][accCount - 1];
+		bAxyz[2] = Axyz[2][accCount - 1];
+	}
+
+	if (gyroCount > 0) {
+		updated = true;
+	}
+	if (gyroCount > 0 || accCount > 0) {
+		invalidateOutputs();
+	}
+}
+
+template <typename Backend>
+void GenericSensorFusion<Backend>::invalidateOutputs() {
+	quatReady = false;
 	gravityReady = false;
 	linaccelReady = false;
 }
 
-bool SensorFusion::isUpdated() { return updated; }
+template <typename Backend>
+bool GenericSensorFusion<Backend>::isUpdated() { return updated; }
 
-void SensorFusion::clearUpdated() { updated = false; }
+template <typename Backend>
+void GenericSensorFusion<Backend>::clearUpdated() { updated = false; }
 
-sensor_real_t const* SensorFusion::getQuaternion() {
-	if (magExist) {
-		vqf.getQuat9D(qwxyz);
-	} else {
-		vqf.getQuat6D(qwxyz);
+template <typename Backend>
+sensor_real_t const* GenericSensorFusion<Backend>::getQuaternion() {
+	if (!quatReady) {
+		if (magExist) {
+			fusion.getQuat9D(qwxyz);
+		} else {
+			fusion.getQuat6D(qwxyz);
+		}
+		quatReady = true;
 	}
 
 	return qwxyz;
 }
 
-Quat SensorFusion::getQuaternionQuat() {
+template <typename Backend>
+Quat GenericSensorFusion<Backend>::getQuaternionQuat() {
 	getQuaternion();
 	return Quat(qwxyz[1], qwxyz[2], qwxyz[3], qwxyz[0]);
 }
 
-sensor_real_t const* SensorFusion::getGravityVec() {
+template <typename Backend>
+sensor_real_t const* GenericSensorFusion<Backend>::getGravityVec() {
 	if (!gravityReady) {
-		calcGravityVec(qwxyz, vecGravity);
+		fusion.getGravity(vecGravity);
 		gravityReady = true;
 	}
 	return vecGravity;
 }
 
-sensor_real_t const* SensorFusion::getLinearAcc() {
+template <typename Backend>
+sensor_real_t const* GenericSensorFusion<Backend>::getLinearAcc() {
 	if (!linaccelReady) {
 		getGravityVec();
 		calcLinearAcc(bAxyz, vecGravity, linAccel);
@@ -95,17 +179,20 @@ sensor_real_t const* SensorFusion::getLinearAcc() {
 	return linAccel;
 }
 
-void SensorFusion::getLinearAcc(sensor_real_t outLinAccel[3]) {
+template <typename Backend>
+void GenericSensorFusion<Backend>::getLinearAcc(sensor_real_t outLinAccel[3]) {
 	getLinearAcc();
 	std::copy(linAccel, linAccel + 3, outLinAccel);
 }
 
-Vector3 SensorFusion::getLinearAccVec() {
+template <typename Backend>
+Vector3 GenericSensorFusion<Backend>::getLinearAccVec() {
 	getLinearAcc();
 	return Vector3(linAccel[0], linAccel[1], linAccel[2]);
 }
 
-void SensorFusion::calcGravityVec(
+template <typename Backend>
+void GenericSensorFusion<Backend>::calcGravityVec(
 	const sensor_real_t qwxyz[4],
 	sensor_real_t gravVec[3]
 ) {
@@ -115,7 +202,8 @@ void SensorFusion::calcGravityVec(
 			   + qwxyz[3] * qwxyz[3];
 }
 
-void SensorFusion::calcLinearAcc(
+template <typename Backend>
+void GenericSensorFusion<Backend>::calcLinearAcc(
 	const sensor_real_t accin[3],
 	const sensor_real_t gravVec[3],
 	sensor_real_t accout[3]
@@ -125,10 +213,18 @@ void SensorFusion::calcLinearAcc(
 	accout[2] = accin[2] - gravVec[2] * CONST_EARTH_GRAVITY;
 }
 
-void SensorFusion::updateBiasForgettingTime(float biasForgettingTime) {
-	vqf.updateBiasForgettingTime(biasForgettingTime);
+template <typename Backend>
+void GenericSensorFusion<Backend>::updateBiasForgettingTime(float biasForgettingTime) {
+	fusion.updateBiasForgettingTime(biasForgettingTime);
+}
+
+template <typename Backend>
+bool GenericSensorFusion<Backend>::getRestDetected() const {
+	return fusion.getRestDetected();
 }
 
-bool SensorFusion::getRestDetected() const { return vqf.getRestDetected(); }
+template class GenericSensorFusion<VQF>;
+template class GenericSensorFusion<BasicVQFFusion>;
+template class GenericSensorFusion<FixedPointFusion>;
 
 }  // namespace SlimeVR::Sensors
@@ -6,10 +6,33 @@
 
 #define SENSOR_DOUBLE_PRECISION 0
 
-#define SENSOR_FUSION_TYPE_STRING "vqf"
+#define SENSOR_FUSION_VQF 1
+// Integer-only filter for chips without an FPU, like the ESP8266
+#define SENSOR_FUSION_FIXED_POINT 2
+// VQF without bias estimation and magnetic disturbance rejection
+#define SENSOR_FUSION_BASIC_VQF 3
+
+// Backend used by sensors that don't pick one themselves, softfusion drivers can
+// override it with a FusionBackend member type
+#ifndef SENSOR_FUSION_TYPE
+#define SENSOR_FUSION_TYPE SENSOR_FUSION_VQF
+#endif
 
 #include <vqf.h>
 
+#include "../motionprocessing/BasicVQFFusion.h"
+#include "../motionprocessing/FixedPointFusion.h"
+
+#if SENSOR_FUSION_TYPE == SENSOR_FUSION_VQF
+#define SENSOR_FUSION_TYPE_STRING "vqf"
+#elif SENSOR_FUSION_TYPE == SENSOR_FUSION_FIXED_POINT
+#define SENSOR_FUSION_TYPE_STRING "fixedpoint"
+#elif SENSOR_FUSION_TYPE == SENSOR_FUSION_BASIC_VQF
+#define SENSOR_FUSION_TYPE_STRING "basicvqf"
+#else
+#error "Unknown SENSOR_FUSION_TYPE"
+#endif
+
 #include "../motionprocessing/types.h"
 
 namespace SlimeVR::Sensors {
@@ -20,9 +43,20 @@ constexpr VQFParams DefaultVQFParams = VQFParams{
 	.restThAcc = 0.06f,
 };
 
-class SensorFusion {
+#if SENSOR_FUSION_TYPE == SENSOR_FUSION_FIXED_POINT
+using DefaultFusionBackend = FixedPointFusion;
+#elif SENSOR_FUSION_TYPE == SENSOR_FUSION_BASIC_VQF
+using DefaultFusionBackend = BasicVQFFusion;
+#else
+using DefaultFusionBackend = VQF;
+#endif
+
+// Backend is one of VQF, BasicVQFFusion or FixedPointFusion, which share the
+// constructor, update and getter signatures used here
+template <typename Backend>
+class GenericSensorFusion {
 public:
-	SensorFusion(
+	GenericSensorFusion(
 		VQFParams vqfParams,
 		sensor_real_t gyrTs,
 		sensor_real_t accTs = -1.0,
@@ -32,17 +66,17 @@ public:
 		, accTs((accTs < 0) ? gyrTs : accTs)
 		, magTs((magTs < 0) ? gyrTs : magTs)
 		, vqfParams(vqfParams)
-		, vqf(this->vqfParams,
-			  gyrTs,
-			  ((accTs < 0) ? gyrTs : accTs),
-			  ((magTs < 0) ? gyrTs : magTs)) {}
+		, fusion(this->vqfParams,
+				 gyrTs,
+				 ((accTs < 0) ? gyrTs : accTs),
+				 ((magTs < 0) ? gyrTs : magTs)) {}
 
-	explicit SensorFusion(
+	explicit GenericSensorFusion(
 		sensor_real_t gyrTs,
 		sensor_real_t accTs = -1.0,
 		sensor_real_t magTs = -1.0
 	)
-		: SensorFusion(DefaultVQFParams, gyrTs, accTs, magTs) {}
+		: GenericSensorFusion(DefaultVQFParams, gyrTs, accTs, magTs) {}
 
 	void update6D(
 		sensor_real_t Axyz[3],
@@ -58,6 +92,17 @@ public:
 	void updateAcc(const sensor_real_t Axyz[3], sensor_real_t deltat = -1.0f);
 	void updateMag(const sensor_real_t Mxyz[3], sensor_real_t deltat = -1.0f);
 	void updateGyro(const sensor_real_t Gxyz[3], sensor_real_t deltat = -1.0f);
+	// Feeds a batch of samples stored as per-axis arrays, interleaving accel and gyro
+	// samples in the order they were sampled. Gdt/Adt hold the time since the
+	// previous sample of the same kind
+	void updateBatch(
+		const sensor_real_t* const Gxyz[3],
+		const sensor_real_t Gdt[],
+		size_t gyroCount,
+		const sensor_real_t* const Axyz[3],
+		const sensor_real_t Adt[],
+		size_t accCount
+	);
 
 	bool isUpdated();
 	void clearUpdated();
@@ -80,17 +125,21 @@ public:
 	[[nodiscard]] bool getRestDetected() const;
 
 protected:
+	// Cached outputs are recomputed on first use after any update
+	void invalidateOutputs();
+
 	sensor_real_t gyrTs;
 	sensor_real_t accTs;
 	sensor_real_t magTs;
 
 	VQFParams vqfParams;
-	VQF vqf;
+	Backend fusion;
 
 	// A also used for linear acceleration extraction
 	sensor_real_t bAxyz[3]{0.0f, 0.0f, 0.0f};
 
 	bool magExist = false;
+	bool quatReady = false;
 	sensor_real_t qwxyz[4]{1.0f, 0.0f, 0.0f, 0.0f};
 	bool updated = false;
 
@@ -102,6 +151,8 @@ protected:
 	sensor_real_t linAccel_guard;  // Temporary patch for some weird ESP32 bug
 #endif
 };
+
+using SensorFusion = GenericSensorFusion<DefaultFusionBackend>;
 }  // namespace SlimeVR::Sensors
 
 #endif  // SLIMEVR_SENSORFUSION_H
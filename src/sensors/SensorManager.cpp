@@ -23,17 +23,27 @@
 
 #include "SensorManager.h"
 
+#include <algorithm>
+#include <map>
+
 #include "SensorBuilder.h"
 
+#if USE_SENSOR_TASK && (!defined(ESP32) || CONFIG_FREERTOS_UNICORE)
+#error "USE_SENSOR_TASK needs a dual core ESP32"
+#endif
+
 namespace SlimeVR::Sensors {
 
 void SensorManager::setup() {
 	if (m_MCP.begin_I2C()) {
 		m_Logger.info("MCP initialized");
+		m_MCPFound = true;
 	}
 
 	SensorBuilder sensorBuilder = SensorBuilder(this);
 	uint8_t activeSensorCount = sensorBuilder.buildAllSensors();
+	buildUpdateOrder();
+	negotiateI2CClocks();
 
 	m_Logger.info("%d sensor(s) configured", activeSensorCount);
 	// Check and scan i2c if no sensors active
@@ -46,6 +56,84 @@ void SensorManager::setup() {
 	}
 }
 
+void SensorManager::buildUpdateOrder() {
+	m_UpdateOrder.clear();
+	for (auto& sensor : m_Sensors) {
+		// insert after the last sensor on the same interface, keep the order otherwise
+		auto position = m_UpdateOrder.end();
+		for (auto it = m_UpdateOrder.begin(); it != m_UpdateOrder.end(); ++it) {
+			if ((*it)->m_hwInterface == sensor->m_hwInterface) {
+				position = it + 1;
+			}
+		}
+		m_UpdateOrder.insert(position, sensor.get());
+	}
+}
+
+bool SensorManager::hasOtherI2CDevices(I2CBus bus) const {
+	// The battery monitors and the MCP23X17 sit on the default Wire bus
+	if (bus != I2CBus(PIN_IMU_SCL, PIN_IMU_SDA)) {
+		return false;
+	}
+#if BATTERY_MONITOR == BAT_MCP3021 || BATTERY_MONITOR == BAT_INTERNAL_MCP3021 \
+	|| BATTERY_MONITOR == BAT_MAX17048
+	return true;
+#else
+	return m_MCPFound;
+#endif
+}
+
+void SensorManager::negotiateI2CClocks() {
+	std::map<I2CBus, std::vector<::Sensor*>> busSensors;
+	for (auto* sensor : m_UpdateOrder) {
+		if (!sensor->isWorking() || sensor->m_hwInterface == nullptr
+			|| !sensor->m_hwInterface->isI2C()) {
+			continue;
+		}
+		sensor->m_hwInterface->swapIn();
+		if (const auto bus = getActiveI2CBus()) {
+			busSensors[*bus].push_back(sensor);
+		}
+	}
+
+	for (auto& [bus, sensors] : busSensors) {
+		// Nothing else on the bus was checked at faster clocks, the MAX17048 for
+		// one is a Fast-mode part
+		uint32_t clock = hasOtherI2CDevices(bus) ? I2C_SPEED : I2C_FAST_SPEED;
+		clock = std::min(clock, getMaxWireClock());
+		for (auto* sensor : sensors) {
+			clock = std::min(clock, sensor->m_hwInterface->getMaxI2CClock());
+		}
+		if (clock <= getI2CClock(bus)) {
+			continue;
+		}
+
+		// the slowest sensor sets the pace for the whole bus
+		setI2CClock(bus, clock);
+		bool allSensorsFine = true;
+		for (auto* sensor : sensors) {
+			sensor->m_hwInterface->swapIn();
+			if (!sensor->checkBusAccess()) {
+				allSensorsFine = false;
+				break;
+			}
+		}
+
+		if (allSensorsFine) {
+			m_Logger.info(
+				"I2C bus (SCL %d, SDA %d) running at %d kHz",
+				bus.first,
+				bus.second,
+				clock / 1000
+			);
+		} else {
+			setI2CClock(bus, I2C_SPEED);
+		}
+	}
+
+	startI2CErrorTracking();
+}
+
 void SensorManager::postSetup() {
 	for (auto& sensor : m_Sensors) {
 		if (sensor->isWorking()) {
@@ -55,29 +143,66 @@ void SensorManager::postSetup() {
 			sensor->postSetup();
 		}
 	}
+
+#if USE_SENSOR_TASK
+	xTaskCreatePinnedToCore(
+		sensorTaskMain,
+		"sensors",
+		SensorTaskStackSize,
+		this,
+		SensorTaskPriority,
+		nullptr,
+		SENSOR_TASK_CORE
+	);
+#endif
 }
 
-void SensorManager::update() {
-	// Gather IMU data
-	bool allIMUGood = true;
-	for (auto& sensor : m_Sensors) {
-		if (sensor->isWorking()) {
-			if (sensor->m_hwInterface != nullptr) {
-				sensor->m_hwInterface->swapIn();
+void SensorManager::updateSensors() {
+	// Gather IMU data. Sensors that can split off their bus accesses are pipelined:
+	// the next sensor's FIFO read is started before the previous sensor is fused, so
+	// on buses that read in the background the transfer and the fusion overlap
+	::Sensor* fusionPending = nullptr;
+	for (auto* sensor : m_UpdateOrder) {
+		if (!sensor->isWorking()) {
+			continue;
+		}
+
+		// the bus has to be idle before switching it over to the next sensor
+		if (fusionPending != nullptr) {
+			fusionPending->finishReads();
+		}
+		if (sensor->m_hwInterface != nullptr) {
+			sensor->m_hwInterface->swapIn();
+		}
+
+		if (sensor->startUpdate()) {
+			if (fusionPending != nullptr) {
+				fusionPending->motionLoop();
+			}
+			fusionPending = sensor;
+		} else {
+			if (fusionPending != nullptr) {
+				fusionPending->motionLoop();
+				fusionPending = nullptr;
 			}
 			sensor->motionLoop();
 		}
+	}
+	if (fusionPending != nullptr) {
+		fusionPending->finishReads();
+		fusionPending->motionLoop();
+	}
+
+	bool allIMUGood = true;
+	for (auto& sensor : m_Sensors) {
 		if (sensor->getSensorState() == SensorStatus::SENSOR_ERROR) {
 			allIMUGood = false;
 		}
 	}
+	m_AllIMUGood = allIMUGood;
+}
 
-	statusManager.setStatus(SlimeVR::Status::IMU_ERROR, !allIMUGood);
-
-	if (!networkConnection.isConnected()) {
-		return;
-	}
-
+bool SensorManager::shouldSendBundle() {
 #ifndef PACKET_BUNDLING
 	static_assert(false, "PACKET_BUNDLING not set");
 #endif
@@ -100,11 +225,34 @@ void SensorManager::update() {
 	}
 
 	if (!shouldSend) {
-		return;
+		return false;
 	}
 
 	m_LastBundleSentAtMicros = now;
 #endif
+	return true;
+}
+
+void SensorManager::update() {
+#if USE_SENSOR_TASK
+	statusManager.setStatus(SlimeVR::Status::IMU_ERROR, !m_AllIMUGood);
+	sendQueuedBundles();
+	// The sensors' own packet queues are between the task and this loop only, they
+	// don't need the sensor lock
+	for (auto& sensor : m_Sensors) {
+		sensor->sendQueuedPackets();
+	}
+#else
+	updateSensors();
+	statusManager.setStatus(SlimeVR::Status::IMU_ERROR, !m_AllIMUGood);
+
+	if (!networkConnection.isConnected()) {
+		return;
+	}
+
+	if (!shouldSendBundle()) {
+		return;
+	}
 
 #if PACKET_BUNDLING != PACKET_BUNDLING_DISABLED
 	networkConnection.beginBundle();
@@ -119,6 +267,88 @@ void SensorManager::update() {
 #if PACKET_BUNDLING != PACKET_BUNDLING_DISABLED
 	networkConnection.endBundle();
 #endif
+#endif
 }
 
+#if USE_SENSOR_TASK
+void SensorManager::sensorTaskMain(void* manager) {
+	auto& sensorManager = *static_cast<SensorManager*>(manager);
+	while (true) {
+		{
+			auto sensorLock = sensorManager.lockSensors();
+			sensorManager.updateSensors();
+			sensorManager.queueFusedSamples();
+		}
+		// Give the idle task of this core a chance to run, its watchdog fires otherwise
+		vTaskDelay(1);
+	}
+}
+
+void SensorManager::queueFusedSamples() {
+	if (!shouldSendBundle()) {
+		return;
+	}
+
+	FusedBundle bundle;
+	for (auto& sensor : m_Sensors) {
+		if (bundle.count == bundle.samples.size()) {
+			break;
+		}
+		if (!sensor->isWorking()) {
+			continue;
+		}
+		if (sensor->takeFusedSample(bundle.samples[bundle.count])) {
+			bundle.count++;
+		}
+	}
+
+	// Queued even without samples, the main loop sends the sensors' auxiliary data
+	// along with it. If the main loop stalls for long enough to fill the queue, the
+	// newest data is dropped, same as with a full socket buffer
+	m_FusedBundles.push(bundle);
+}
+
+void SensorManager::sendQueuedBundles() {
+	FusedBundle bundle;
+	while (m_FusedBundles.pop(bundle)) {
+		if (!networkConnection.isConnected()) {
+			continue;
+		}
+
+#if PACKET_BUNDLING != PACKET_BUNDLING_DISABLED
+		networkConnection.beginBundle();
+#endif
+
+		for (size_t i = 0; i < bundle.count; i++) {
+			auto& sample = bundle.samples[i];
+			networkConnection.sendRotationData(
+				sample.sensorId,
+				&sample.rotation,
+				DATA_TYPE_NORMAL,
+				sample.calibrationAccuracy
+			);
+			if (sample.hasAcceleration) {
+				networkConnection.sendSensorAcceleration(
+					sample.sensorId,
+					sample.acceleration
+				);
+			}
+		}
+
+		{
+			auto sensorLock = lockSensors();
+			for (auto& sensor : m_Sensors) {
+				if (sensor->isWorking()) {
+					sensor->sendAuxiliaryData();
+				}
+			}
+		}
+
+#if PACKET_BUNDLING != PACKET_BUNDLING_DISABLED
+		networkConnection.endBundle();
+#endif
+	}
+}
+#endif
+
 }  // namespace SlimeVR::Sensors
@@ -24,11 +24,17 @@
 
 #include <i2cscan.h>
 
+#include <array>
+#include <atomic>
 #include <memory>
+#if USE_SENSOR_TASK
+#include <mutex>
+#endif
 #include <optional>
 
 #include "EmptySensor.h"
 #include "ErroneousSensor.h"
+#include "SPSCQueue.h"
 #include "globals.h"
 #include "logging/Logger.h"
 #include "sensorinterface/DirectPinInterface.h"
@@ -57,11 +63,57 @@ public:
 		return SensorTypeID::Unknown;
 	}
 
+#if USE_SENSOR_TASK
+	using SensorLock = std::unique_lock<std::recursive_mutex>;
+#else
+	struct SensorLock {
+		~SensorLock() {}
+	};
+#endif
+	// The sensor task holds this while it updates the sensors. Code in the main loop
+	// that calls into the sensors or uses their buses has to hold it as well
+	[[nodiscard]] SensorLock lockSensors() {
+#if USE_SENSOR_TASK
+		return SensorLock(m_SensorMutex);
+#else
+		return {};
+#endif
+	}
+
 private:
 	SlimeVR::Logging::Logger m_Logger;
 
 	std::vector<std::unique_ptr<::Sensor>> m_Sensors;
+	// m_Sensors grouped by bus interface, so that swapping between sensors on the same
+	// bus or mux channel doesn't touch the bus
+	std::vector<::Sensor*> m_UpdateOrder;
+	void buildUpdateOrder();
+	void negotiateI2CClocks();
+	bool hasOtherI2CDevices(I2CBus bus) const;
+
+	void updateSensors();
+	bool shouldSendBundle();
+	std::atomic<bool> m_AllIMUGood{true};
+
+#if USE_SENSOR_TASK
+	// With the sensor task the main loop only sends, it gets the fused samples of
+	// every update bundled together. Everything else sendData() would send is read
+	// from the sensors under lockSensors() when the bundle is sent
+	struct FusedBundle {
+		size_t count = 0;
+		std::array<FusedSample, MAX_SENSORS_COUNT> samples;
+	};
+	SPSCQueue<FusedBundle, 4> m_FusedBundles;
+	std::recursive_mutex m_SensorMutex;
+
+	static constexpr uint32_t SensorTaskStackSize = 8192;
+	static constexpr UBaseType_t SensorTaskPriority = 1;
+	static void sensorTaskMain(void* manager);
+	void queueFusedSamples();
+	void sendQueuedBundles();
+#endif
 	Adafruit_MCP23X17 m_MCP;
+	bool m_MCPFound = false;
 
 	uint32_t m_LastBundleSentAtMicros = micros();
 
@@ -28,29 +28,57 @@
 #include "globals.h"
 
 void BNO055Sensor::motionSetup() {
-	imu = Adafruit_BNO055(sensorId, addr);
-	delay(3000);
+	while (!motionSetupStep()) {
+		delay(1);
+	}
+}
+
+// The boot and mode switch waits are taken without blocking, so the other sensors
+// set up in the meantime
+bool BNO055Sensor::motionSetupStep() {
+	switch (m_setupState) {
+		case SetupState::Start:
+			imu = Adafruit_BNO055(sensorId, addr);
+			m_setupStepMillis = millis();
+			m_setupState = SetupState::WaitForBoot;
+			return false;
+		case SetupState::WaitForBoot:
+			if (millis() - m_setupStepMillis < BootMillis) {
+				return false;
+			}
 #if USE_6_AXIS
-	if (!imu.begin(Adafruit_BNO055::OPERATION_MODE_IMUPLUS))
+			if (!imu.begin(Adafruit_BNO055::OPERATION_MODE_IMUPLUS))
 #else
-	if (!imu.begin(Adafruit_BNO055::OPERATION_MODE_NDOF))
+			if (!imu.begin(Adafruit_BNO055::OPERATION_MODE_NDOF))
 #endif
-	{
-		m_Logger.fatal("Can't connect to BNO055 at address 0x%02x", addr);
-		ledManager.pattern(50, 50, 200, CRGB::HTMLColorCode::SaddleBrown);
-		return;
-	}
-
-	delay(1000);
-	imu.setExtCrystalUse(true);  // Adafruit BNO055's use external crystal. Enable it,
-								 // otherwise it does not work.
-	imu.setAxisRemap(Adafruit_BNO055::REMAP_CONFIG_P0);
-	imu.setAxisSign(Adafruit_BNO055::REMAP_SIGN_P0);
-	m_Logger.info("Connected to BNO055 at address 0x%02x", addr);
+			{
+				m_Logger.fatal("Can't connect to BNO055 at address 0x%02x", addr);
+				ledManager.pattern(50, 50, 200, CRGB::HTMLColorCode::SaddleBrown);
+				m_setupState = SetupState::Done;
+				return true;
+			}
+			m_setupStepMillis = millis();
+			m_setupState = SetupState::WaitForModeSwitch;
+			return false;
+		case SetupState::WaitForModeSwitch:
+			if (millis() - m_setupStepMillis < ModeSwitchMillis) {
+				return false;
+			}
+			imu.setExtCrystalUse(true);  // Adafruit BNO055's use external crystal.
+										 // Enable it, otherwise it does not work.
+			imu.setAxisRemap(Adafruit_BNO055::REMAP_CONFIG_P0);
+			imu.setAxisSign(Adafruit_BNO055::REMAP_SIGN_P0);
+			m_Logger.info("Connected to BNO055 at address 0x%02x", addr);
 
-	working = true;
-	m_tpsCounter.reset();
-	m_dataCounter.reset();
+			working = true;
+			m_tpsCounter.reset();
+			m_dataCounter.reset();
+			m_setupState = SetupState::Done;
+			return true;
+		case SetupState::Done:
+			return true;
+	}
+	return true;
 }
 
 void BNO055Sensor::motionLoop() {
@@ -61,8 +89,7 @@ void BNO055Sensor::motionLoop() {
 		Vector3 accel = imu.getVector(Adafruit_BNO055::VECTOR_LINEARACCEL);
 		Vector3 mag = imu.getVector(Adafruit_BNO055::VECTOR_MAGNETOMETER);
 
-		networkConnection.sendInspectionRawIMUData(
-			sensorId,
+		sendInspectionRawIMUData(
 			UNPACK_VECTOR(gyro),
 			255,
 			UNPACK_VECTOR(accel),
@@ -79,13 +106,13 @@ void BNO055Sensor::motionLoop() {
 		markRestCalibrationComplete();
 	}
 
-	// TODO Optimize a bit with setting rawQuat directly
-	setFusedRotation(imu.getQuat());
-	hadData = true;
-
 #if SEND_ACCELERATION
 	setAcceleration(imu.getVector(Adafruit_BNO055::VECTOR_LINEARACCEL));
 #endif
+
+	// TODO Optimize a bit with setting rawQuat directly
+	setFusedRotation(imu.getQuat());
+	hadData = true;
 }
 
 void BNO055Sensor::startCalibration(int calibrationType) {}
@@ -51,10 +51,24 @@ public:
 		){};
 	~BNO055Sensor(){};
 	void motionSetup() override final;
+	bool motionSetupStep() override final;
 	void motionLoop() override final;
 	void startCalibration(int calibrationType) override final;
 
 private:
+	static constexpr uint32_t BootMillis = 3000;
+	static constexpr uint32_t ModeSwitchMillis = 1000;
+
+	enum class SetupState {
+		Start,
+		WaitForBoot,
+		WaitForModeSwitch,
+		Done,
+	};
+
+	SetupState m_setupState = SetupState::Start;
+	uint32_t m_setupStepMillis = 0;
+
 	Adafruit_BNO055 imu;
 	SlimeVR::Configuration::BNO0XXSensorConfig m_Config = {};
 };
@@ -146,12 +146,21 @@ void BNO080Sensor::motionSetup() {
 
 void BNO080Sensor::motionLoop() {
 	m_tpsCounter.update();
-	// Look for reports from the IMU
+	// Look for reports from the IMU, leaving the rest for the next loop if it runs
+	// over budget
+	m_loopBudget.start();
 	while (imu.dataAvailable()) {
 		hadData = true;
 		lastReset = 0;
 		lastData = millis();
 
+		// A report read over budget stays parsed in imu, it's handled together with
+		// the first report of the next loop
+		if (!m_loopBudget.take()) {
+			m_fifoHealth.deferredReads++;
+			break;
+		}
+
 #if ENABLE_INSPECTION
 		{
 			if (imu.hasNewRawAccel() && imu.hasNewRawGyro() && imu.hasNewRawMag()) {
@@ -166,8 +175,7 @@ void BNO080Sensor::motionLoop() {
 
 				// only send Data when we have a set of new data
 
-				networkConnection.sendInspectionRawIMUData(
-					sensorId,
+				sendInspectionRawIMUData(
 					rX,
 					rY,
 					rZ,
@@ -302,7 +310,7 @@ void BNO080Sensor::motionLoop() {
 		uint8_t rr = imu.resetReason();
 		if (rr != lastReset) {
 			lastReset = rr;
-			networkConnection.sendSensorError(this->sensorId, rr);
+			sendSensorError(rr);
 		}
 
 		m_Logger.error(
@@ -332,31 +340,7 @@ SensorStatus BNO080Sensor::getSensorState() {
 					   : SensorStatus::SENSOR_OFFLINE;
 }
 
-void BNO080Sensor::sendData() {
-	if (newFusedRotation) {
-		newFusedRotation = false;
-		networkConnection.sendRotationData(
-			sensorId,
-			&fusedRotation,
-			DATA_TYPE_NORMAL,
-			calibrationAccuracy
-		);
-
-#ifdef DEBUG_SENSOR
-		m_Logger.trace("Quaternion: %f, %f, %f, %f", UNPACK_QUATERNION(fusedRotation));
-#endif
-
-#if SEND_ACCELERATION
-		if (newAcceleration) {
-			newAcceleration = false;
-			networkConnection.sendSensorAcceleration(
-				this->sensorId,
-				this->acceleration
-			);
-		}
-#endif
-	}
-
+void BNO080Sensor::sendAuxiliaryData() {
 	sendTempIfNeeded();
 
 	if (tap != 0) {
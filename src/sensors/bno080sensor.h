@@ -27,6 +27,7 @@
 #include <BNO080.h>
 #include <i2cscan.h>
 
+#include "LoopBudget.h"
 #include "sensor.h"
 #include "sensorinterface/RegisterInterface.h"
 
@@ -59,10 +60,13 @@ public:
 	void postSetup() override { lastData = millis(); }
 
 	void motionLoop() override final;
-	void sendData() override final;
+	void sendAuxiliaryData() override final;
 	void startCalibration(int calibrationType) override final;
 	SensorStatus getSensorState() override final;
 	bool isFlagSupported(SensorToggles toggle) const final;
+	const SlimeVR::Sensors::FifoHealth* getFifoHealth() const final {
+		return &m_fifoHealth;
+	}
 	void sendTempIfNeeded();
 
 	static SensorTypeID checkPresent(
@@ -97,6 +101,8 @@ private:
 	uint8_t lastReset = 0;
 	BNO080Error lastError{};
 	SlimeVR::Configuration::BNO0XXSensorConfig m_Config = {};
+	SlimeVR::Sensors::FifoHealth m_fifoHealth;
+	SlimeVR::Sensors::LoopBudget m_loopBudget{2000, 8};
 
 	// Magnetometer specific members
 	Quat magQuaternion{};
@@ -68,8 +68,7 @@ void ICM20948Sensor::motionLoop() {
 		float mY = imu.magY();
 		float mZ = imu.magZ();
 
-		networkConnection.sendInspectionRawIMUData(
-			sensorId,
+		sendInspectionRawIMUData(
 			rX,
 			rY,
 			rZ,
@@ -105,49 +104,32 @@ void ICM20948Sensor::motionLoop() {
 }
 
 void ICM20948Sensor::readFIFOToEnd() {
-	ICM_20948_Status_e readStatus = imu.readDMPdataFromFIFO(&dmpDataTemp);
+	// Quaternions from the DMP are absolute, so only the newest frame is kept
+	m_loopBudget.start();
+	while (m_loopBudget.take()) {
+		ICM_20948_Status_e readStatus = imu.readDMPdataFromFIFO(&dmpDataTemp);
 
 #ifdef DEBUG_SENSOR
-	{ m_Logger.trace("e0x%02x", readStatus); }
+		{ m_Logger.trace("e0x%02x", readStatus); }
 #endif
 
-	if (readStatus == ICM_20948_Stat_Ok) {
+		if (readStatus != ICM_20948_Stat_Ok
+			&& readStatus != ICM_20948_Stat_FIFOMoreDataAvail) {
+			return;
+		}
+
 		dmpData = dmpDataTemp;
 		// Performance Test
 		//        cntbuf ++;
 		hasdata = true;
 		hadData = true;
-		readFIFOToEnd();
-	}
-}
 
-void ICM20948Sensor::sendData() {
-	if (newFusedRotation) {
-		newFusedRotation = false;
-
-#if (USE_6_AXIS)
-		{
-			networkConnection
-				.sendRotationData(sensorId, &fusedRotation, DATA_TYPE_NORMAL, 0);
-		}
-#else
-		{
-			networkConnection.sendRotationData(
-				sensorId,
-				&fusedRotation,
-				DATA_TYPE_NORMAL,
-				dmpData.Quat9.Data.Accuracy
-			);
-		}
-#endif
-
-#if SEND_ACCELERATION
-		if (newAcceleration) {
-			newAcceleration = false;
-			networkConnection.sendSensorAcceleration(sensorId, acceleration);
+		if (readStatus == ICM_20948_Stat_Ok) {
+			// That was the last complete frame in the FIFO
+			return;
 		}
-#endif
 	}
+	m_fifoHealth.deferredReads++;
 }
 
 void ICM20948Sensor::startCalibration(int calibrationType) {
@@ -332,10 +314,7 @@ void ICM20948Sensor::checkSensorTimeout() {
 			addr,
 			currenttime - lastData
 		);
-		networkConnection.sendSensorError(
-			this->sensorId,
-			static_cast<uint8_t>(PacketErrorCode::WATCHDOG_TIMEOUT)
-		);
+		sendSensorError(static_cast<uint8_t>(PacketErrorCode::WATCHDOG_TIMEOUT));
 		lastData = currenttime;
 	}
 }
@@ -391,6 +370,7 @@ void ICM20948Sensor::readRotation() {
 			calculateAccelerationWithoutGravity(&nRotation);
 #endif
 
+			calibrationAccuracy = dmpData.Quat9.Data.Accuracy;
 			setFusedRotation(nRotation);
 			lastData = millis();
 		}
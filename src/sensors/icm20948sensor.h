@@ -25,6 +25,7 @@
 
 #include <ICM_20948.h>
 
+#include "LoopBudget.h"
 #include "SensorFusionDMP.h"
 #include "sensor.h"
 
@@ -54,8 +55,10 @@ public:
 	void postSetup() override { this->lastData = millis(); }
 
 	void motionLoop() override final;
-	void sendData() override final;
 	void startCalibration(int calibrationType) override final;
+	const SlimeVR::Sensors::FifoHealth* getFifoHealth() const final {
+		return &m_fifoHealth;
+	}
 
 private:
 	void calculateAccelerationWithoutGravity(Quat* quaternion);
@@ -79,6 +82,8 @@ private:
 	SlimeVR::Configuration::ICM20948SensorConfig m_Config = {};
 
 	SlimeVR::Sensors::SensorFusionDMP sfusion;
+	SlimeVR::Sensors::FifoHealth m_fifoHealth;
+	SlimeVR::Sensors::LoopBudget m_loopBudget{2000, 8};
 
 	void saveCalibration(bool repeat);
 	void loadCalibration();
@@ -144,8 +144,7 @@ void MPU6050Sensor::motionLoop() {
 		imu.getRotation(&rX, &rY, &rZ);
 		imu.getAcceleration(&aX, &aY, &aZ);
 
-		networkConnection.sendInspectionRawIMUData(
-			sensorId,
+		sendInspectionRawIMUData(
 			rX,
 			rY,
 			rZ,
@@ -172,8 +171,6 @@ void MPU6050Sensor::motionLoop() {
 
 		sfusion.updateQuaternion(rawQuat);
 
-		setFusedRotation(sfusion.getQuaternionQuat());
-
 #if SEND_ACCELERATION
 		{
 			this->imu.dmpGetAccel(&this->rawAccel, this->fifoBuffer);
@@ -188,6 +185,8 @@ void MPU6050Sensor::motionLoop() {
 			setAcceleration(sfusion.getLinearAccVec());
 		}
 #endif
+
+		setFusedRotation(sfusion.getQuaternionQuat());
 	}
 }
 
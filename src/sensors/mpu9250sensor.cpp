@@ -165,8 +165,7 @@ void MPU9250Sensor::motionLoop() {
 		imu.getAcceleration(&aX, &aY, &aZ);
 		imu.getMagnetometer(&mX, &mY, &mZ);
 
-		networkConnection.sendInspectionRawIMUData(
-			sensorId,
+		sendInspectionRawIMUData(
 			rX,
 			rY,
 			rZ,
@@ -216,9 +215,10 @@ void MPU9250Sensor::motionLoop() {
 #endif
 #else
 	union fifo_sample_raw buf;
-	uint16_t remaining_samples;
+	uint16_t remaining_samples = 0;
 	// TODO: would it be faster to read multiple samples at once
-	while (getNextSample(&buf, &remaining_samples)) {
+	m_loopBudget.start();
+	while (m_loopBudget.take() && getNextSample(&buf, &remaining_samples)) {
 		parseAccelData(buf.sample.accel);
 		parseGyroData(buf.sample.gyro);
 		parseMagData(buf.sample.mag);
@@ -227,16 +227,18 @@ void MPU9250Sensor::motionLoop() {
 		// buf.sample.mag_status;
 		// TODO: monitor interrupts
 		// imu.getIntStatus();
-		// TODO: monitor remaining_samples to ensure that the number is going down, not
-		// up. remaining_samples
 
 		sfusion.update9D(Axyz, Gxyz, Mxyz);
 	}
+	m_fifoHealth.recordFillLevel(remaining_samples * sensor_data_len);
+	if (remaining_samples > 0) {
+		m_fifoHealth.deferredReads++;
+	}
 #endif
-	setFusedRotation(sfusion.getQuaternionQuat());
 #if SEND_ACCELERATION
 	setAcceleration(sfusion.getLinearAccVec());
 #endif
+	setFusedRotation(sfusion.getQuaternionQuat());
 }
 
 void MPU9250Sensor::startCalibration(int calibrationType) {
@@ -508,7 +510,9 @@ bool MPU9250Sensor::getNextSample(
 	uint16_t count = imu.getFIFOCount();
 	if (count < sensor_data_len) {
 		// no samples to read
-		remaining_count = 0;
+		if (remaining_count) {
+			*remaining_count = 0;
+		}
 		return false;
 	}
 
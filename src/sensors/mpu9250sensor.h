@@ -39,6 +39,7 @@ constexpr float MPU9250_ODR_TS
 #if MPU_USE_DMPMAG
 #include "SensorFusionDMP.h"
 #else
+#include "LoopBudget.h"
 #include "SensorFusion.h"
 #endif
 
@@ -72,6 +73,11 @@ public:
 	void motionLoop() override final;
 	void startCalibration(int calibrationType) override final;
 	void getMPUScaled();
+#if !MPU_USE_DMPMAG
+	const SlimeVR::Sensors::FifoHealth* getFifoHealth() const final {
+		return &m_fifoHealth;
+	}
+#endif
 
 private:
 	MPU9250 imu{};
@@ -84,6 +90,8 @@ private:
 	SlimeVR::Sensors::SensorFusionDMP sfusion;
 #else
 	SlimeVR::Sensors::SensorFusion sfusion;
+	SlimeVR::Sensors::FifoHealth m_fifoHealth;
+	SlimeVR::Sensors::LoopBudget m_loopBudget{2000, 8};
 #endif
 
 	// raw data and scaled as vector
@@ -42,8 +42,21 @@ void Sensor::setFusedRotation(Quat r) {
 					 ? !lastFusedRotationSent.equalsWithEpsilon(fusedRotation)
 					 : true;
 	if (ENABLE_INSPECTION || changed) {
-		newFusedRotation = true;
 		lastFusedRotationSent = fusedRotation;
+
+		FusedSample sample;
+		sample.timestampMicros = micros();
+		sample.sensorId = sensorId;
+		sample.calibrationAccuracy = calibrationAccuracy;
+		sample.rotation = fusedRotation;
+		sample.hasAcceleration = SEND_ACCELERATION && newAcceleration;
+		if (sample.hasAcceleration) {
+			newAcceleration = false;
+			sample.acceleration = acceleration;
+		}
+		if (!m_fusedSamples.pushOverwrite(sample)) {
+			m_droppedFusedSamples++;
+		}
 	}
 	if (changed) {
 		m_dataCounter.update();
@@ -51,27 +64,174 @@ void Sensor::setFusedRotation(Quat r) {
 }
 
 void Sensor::sendData() {
-	if (newFusedRotation) {
-		newFusedRotation = false;
+	// A backlog is worked off over several sends, so bundles of all sensors still fit
+	// a single UDP packet
+	constexpr size_t MaxSamplesPerSend = 2;
+	FusedSample sample;
+	for (size_t i = 0; i < MaxSamplesPerSend && m_fusedSamples.pop(sample); i++) {
 		networkConnection.sendRotationData(
 			sensorId,
-			&fusedRotation,
+			&sample.rotation,
 			DATA_TYPE_NORMAL,
-			calibrationAccuracy
+			sample.calibrationAccuracy
 		);
 
 #ifdef DEBUG_SENSOR
-		m_Logger.trace("Quaternion: %f, %f, %f, %f", UNPACK_QUATERNION(fusedRotation));
+		m_Logger.trace(
+			"Quaternion: %f, %f, %f, %f",
+			UNPACK_QUATERNION(sample.rotation)
+		);
 #endif
 
-#if SEND_ACCELERATION
-		if (newAcceleration) {
-			newAcceleration = false;
-			networkConnection.sendSensorAcceleration(sensorId, acceleration);
+		if (sample.hasAcceleration) {
+			networkConnection.sendSensorAcceleration(sensorId, sample.acceleration);
 		}
+	}
+
+	sendAuxiliaryData();
+}
+
+bool Sensor::takeFusedSample(FusedSample& sample) {
+	return m_fusedSamples.pop(sample);
+}
+
+void Sensor::sendSensorError(uint8_t error) {
+#if USE_SENSOR_TASK
+	m_queuedErrors.push(error);
+#else
+	networkConnection.sendSensorError(sensorId, error);
 #endif
+}
+
+#if ENABLE_INSPECTION
+void Sensor::sendInspectionRawIMUData(
+	int16_t rX,
+	int16_t rY,
+	int16_t rZ,
+	uint8_t rA,
+	int16_t aX,
+	int16_t aY,
+	int16_t aZ,
+	uint8_t aA,
+	int16_t mX,
+	int16_t mY,
+	int16_t mZ,
+	uint8_t mA
+) {
+#if USE_SENSOR_TASK
+	m_queuedInspectionPackets.push({
+		.isInt = true,
+		.values = {rX, rY, rZ, aX, aY, aZ, mX, mY, mZ},
+		.accuracies = {rA, aA, mA},
+	});
+#else
+	networkConnection.sendInspectionRawIMUData(
+		sensorId,
+		rX,
+		rY,
+		rZ,
+		rA,
+		aX,
+		aY,
+		aZ,
+		aA,
+		mX,
+		mY,
+		mZ,
+		mA
+	);
+#endif
+}
+
+void Sensor::sendInspectionRawIMUData(
+	float rX,
+	float rY,
+	float rZ,
+	uint8_t rA,
+	float aX,
+	float aY,
+	float aZ,
+	uint8_t aA,
+	float mX,
+	float mY,
+	float mZ,
+	uint8_t mA
+) {
+#if USE_SENSOR_TASK
+	m_queuedInspectionPackets.push({
+		.isInt = false,
+		.values = {rX, rY, rZ, aX, aY, aZ, mX, mY, mZ},
+		.accuracies = {rA, aA, mA},
+	});
+#else
+	networkConnection.sendInspectionRawIMUData(
+		sensorId,
+		rX,
+		rY,
+		rZ,
+		rA,
+		aX,
+		aY,
+		aZ,
+		aA,
+		mX,
+		mY,
+		mZ,
+		mA
+	);
+#endif
+}
+#endif
+
+#if USE_SENSOR_TASK
+void Sensor::sendQueuedPackets() {
+	uint8_t error;
+	while (m_queuedErrors.pop(error)) {
+		networkConnection.sendSensorError(sensorId, error);
+	}
+
+#if ENABLE_INSPECTION
+	InspectionPacket packet;
+	while (m_queuedInspectionPackets.pop(packet)) {
+		const float* v = packet.values;
+		const uint8_t* a = packet.accuracies;
+		if (packet.isInt) {
+			networkConnection.sendInspectionRawIMUData(
+				sensorId,
+				static_cast<int16_t>(v[0]),
+				static_cast<int16_t>(v[1]),
+				static_cast<int16_t>(v[2]),
+				a[0],
+				static_cast<int16_t>(v[3]),
+				static_cast<int16_t>(v[4]),
+				static_cast<int16_t>(v[5]),
+				a[1],
+				static_cast<int16_t>(v[6]),
+				static_cast<int16_t>(v[7]),
+				static_cast<int16_t>(v[8]),
+				a[2]
+			);
+		} else {
+			networkConnection.sendInspectionRawIMUData(
+				sensorId,
+				v[0],
+				v[1],
+				v[2],
+				a[0],
+				v[3],
+				v[4],
+				v[5],
+				a[1],
+				v[6],
+				v[7],
+				v[8],
+				a[2]
+			);
+		}
 	}
+#endif
 }
+#endif
 
 void Sensor::printTemperatureCalibrationUnsupported() {
 	m_Logger.error(
@@ -92,6 +252,8 @@ void Sensor::resetTemperatureCalibrationState() {
 
 const char* Sensor::getAttachedMagnetometer() const { return nullptr; }
 
+const SlimeVR::Sensors::FifoHealth* Sensor::getFifoHealth() const { return nullptr; }
+
 SlimeVR::Configuration::SensorConfigBits Sensor::getSensorConfigData() {
 	return SlimeVR::Configuration::SensorConfigBits{
 		.magEnabled = toggles.getToggle(SensorToggles::MagEnabled),
@@ -30,7 +30,9 @@
 
 #include <memory>
 
+#include "FifoHealth.h"
 #include "PinInterface.h"
+#include "SPSCQueue.h"
 #include "SensorToggles.h"
 #include "configuration/Configuration.h"
 #include "globals.h"
@@ -50,6 +52,19 @@ enum class SensorStatus : uint8_t {
 	SENSOR_ERROR = 2
 };
 
+// One fused rotation, with the linear acceleration if there was a new one since the
+// previous sample
+struct FusedSample {
+	// micros() when the rotation was fused, so samples can be told apart when
+	// several of one sensor are sent or one is sent again
+	uint32_t timestampMicros;
+	uint8_t sensorId;
+	uint8_t calibrationAccuracy;
+	bool hasAcceleration;
+	Quat rotation;
+	Vector3 acceleration;
+};
+
 class Sensor {
 public:
 	Sensor(
@@ -74,9 +89,37 @@ public:
 
 	virtual ~Sensor(){};
 	virtual void motionSetup(){};
+	// Non-blocking variant of motionSetup(), called until it returns true so the
+	// setup of all sensors can overlap. Sensors that don't implement it set up in
+	// one blocking call.
+	virtual bool motionSetupStep() {
+		motionSetup();
+		return true;
+	}
 	virtual void postSetup(){};
+	// Whether the sensor reads fine over the bus it's swapped in on, used to check a
+	// faster bus clock. Sensors that can't tell keep their bus at the default clock.
+	virtual bool checkBusAccess() { return false; }
+	// Pipelined update, see SensorManager::update(). Sensors returning true have done
+	// all their bus accesses, possibly leaving reads running until finishReads(), and
+	// leave the bus alone in the following motionLoop(). The others do everything in
+	// motionLoop().
+	virtual bool startUpdate() { return false; }
+	void finishReads() { m_RegisterInterface.finishReads(); }
 	virtual void motionLoop(){};
 	virtual void sendData();
+	// Everything sendData() sends besides the fused samples, like temperatures and
+	// taps. With the sensor task the main loop calls it under
+	// SensorManager::lockSensors() when it sends the fused samples
+	virtual void sendAuxiliaryData(){};
+	// Takes the oldest sample sendData() didn't send yet, returns false if there is
+	// none
+	bool takeFusedSample(FusedSample& sample);
+#if USE_SENSOR_TASK
+	// Sends the packets motionLoop() queued in the sensor task, called from the main
+	// loop
+	void sendQueuedPackets();
+#endif
 	virtual void setAcceleration(Vector3 a);
 	virtual void setFusedRotation(Quat r);
 	virtual void startCalibration(int calibrationType){};
@@ -88,6 +131,8 @@ public:
 	// TODO: currently only for softfusionsensor, bmi160 and others should get
 	// an overload too
 	virtual const char* getAttachedMagnetometer() const;
+	// nullptr for sensors that don't read through a FIFO
+	virtual const SlimeVR::Sensors::FifoHealth* getFifoHealth() const;
 	// TODO: realistically each sensor should print its own state instead of
 	// having 15 getters for things only the serial commands use
 	bool isWorking() { return working; };
@@ -97,7 +142,8 @@ public:
 	SensorTypeID getSensorType() { return sensorType; };
 	const Vector3& getAcceleration() { return acceleration; };
 	const Quat& getFusedRotation() { return fusedRotation; };
-	bool hasNewDataToSend() { return newFusedRotation || newAcceleration; };
+	bool hasNewDataToSend() { return !m_fusedSamples.empty(); };
+	uint32_t getDroppedFusedSamples() const { return m_droppedFusedSamples; };
 	inline bool hasCompletedRestCalibration() { return restCalibrationComplete; }
 	void setFlag(SensorToggles toggle, bool state);
 	[[nodiscard]] virtual bool isFlagSupported(SensorToggles toggle) const {
@@ -133,24 +179,82 @@ protected:
 	 */
 	Quat sensorOffset;
 
-	bool newFusedRotation = false;
 	Quat fusedRotation{};
 	Quat lastFusedRotationSent{};
 
 	bool newAcceleration = false;
 	Vector3 acceleration{};
 
+	// Samples not sent yet, so a slow send doesn't lose samples. Once it's full the
+	// oldest sample is evicted, the server is better off with the newest rotation.
+	// motionLoop() produces, sendData() or takeFusedSample() consume, each may run on
+	// its own thread
+	static constexpr size_t FusedSampleBufferSize = 8;
+	SlimeVR::SPSCQueue<FusedSample, FusedSampleBufferSize> m_fusedSamples;
+	uint32_t m_droppedFusedSamples = 0;
+
 	SensorPosition m_SensorPosition = SensorPosition::POSITION_NO;
 
 	SensorToggleState toggles;
 
 	void markRestCalibrationComplete(bool completed = true);
 
+	// With USE_SENSOR_TASK motionLoop() runs in the sensor task, which must not use
+	// the connection while the main loop does. Use these from motionLoop() instead,
+	// they send right away without the task and queue the packet for
+	// sendQueuedPackets() with it
+	void sendSensorError(uint8_t error);
+#if ENABLE_INSPECTION
+	void sendInspectionRawIMUData(
+		int16_t rX,
+		int16_t rY,
+		int16_t rZ,
+		uint8_t rA,
+		int16_t aX,
+		int16_t aY,
+		int16_t aZ,
+		uint8_t aA,
+		int16_t mX,
+		int16_t mY,
+		int16_t mZ,
+		uint8_t mA
+	);
+	void sendInspectionRawIMUData(
+		float rX,
+		float rY,
+		float rZ,
+		uint8_t rA,
+		float aX,
+		float aY,
+		float aZ,
+		uint8_t aA,
+		float mX,
+		float mY,
+		float mZ,
+		uint8_t mA
+	);
+#endif
+
 	mutable SlimeVR::Logging::Logger m_Logger;
 
 private:
 	void printTemperatureCalibrationUnsupported();
 
+#if USE_SENSOR_TASK
+	// Errors are rare and repeated while the sensor stays broken, a full queue drops
+	// the newest
+	SlimeVR::SPSCQueue<uint8_t, 4> m_queuedErrors;
+#if ENABLE_INSPECTION
+	struct InspectionPacket {
+		bool isInt;
+		// Gyro, accel and mag, int16_t values are exact as floats
+		float values[9];
+		uint8_t accuracies[3];
+	};
+	SlimeVR::SPSCQueue<InspectionPacket, 8> m_queuedInspectionPackets;
+#endif
+#endif
+
 	bool restCalibrationComplete = false;
 };
 
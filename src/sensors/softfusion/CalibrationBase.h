@@ -37,8 +37,12 @@ namespace SlimeVR::Sensors {
 template <typename IMU>
 class CalibrationBase {
 public:
+	using Consts = IMUConsts<IMU>;
+	using RawSensorT = typename Consts::RawSensorT;
+	using Fusion = typename Consts::Fusion;
+
 	CalibrationBase(
-		SlimeVR::Sensors::SensorFusion& fusion,
+		Fusion& fusion,
 		IMU& sensor,
 		uint8_t sensorId,
 		SlimeVR::Logging::Logger& logger,
@@ -50,9 +54,6 @@ public:
 		, logger{logger}
 		, toggles{toggles} {}
 
-	using Consts = IMUConsts<IMU>;
-	using RawSensorT = typename Consts::RawSensorT;
-
 	static constexpr bool HasMotionlessCalib
 		= requires(IMU& i) { typename IMU::MotionlessCalibrationData; };
 	static constexpr size_t MotionlessCalibDataSize() {
@@ -85,6 +86,44 @@ public:
 
 	virtual float getTempTimestep() = 0;
 
+	// Raw aux magnetometer samples, left as they are unless the calibrator stores a
+	// mag calibration
+	virtual void scaleMagSample(sensor_real_t magSample[3]) {}
+	// Uncalibrated mag data would pull the heading off, so it's only fused once
+	// there is a calibration for it
+	virtual bool hasMagCalibration() { return false; }
+
+	// Batch variants of the above, samples are stored as one array per axis
+	virtual void scaleAccelBatch(
+		sensor_real_t x[],
+		sensor_real_t y[],
+		sensor_real_t z[],
+		size_t count
+	) {
+		for (size_t i = 0; i < count; i++) {
+			sensor_real_t sample[3]{x[i], y[i], z[i]};
+			scaleAccelSample(sample);
+			x[i] = sample[0];
+			y[i] = sample[1];
+			z[i] = sample[2];
+		}
+	}
+
+	virtual void scaleGyroBatch(
+		sensor_real_t x[],
+		sensor_real_t y[],
+		sensor_real_t z[],
+		size_t count
+	) {
+		for (size_t i = 0; i < count; i++) {
+			sensor_real_t sample[3]{x[i], y[i], z[i]};
+			scaleGyroSample(sample);
+			x[i] = sample[0];
+			y[i] = sample[1];
+			z[i] = sample[2];
+		}
+	}
+
 	virtual const uint8_t* getMotionlessCalibrationData() = 0;
 
 	virtual void provideAccelSample(const RawSensorT accelSample[3]) {}
@@ -95,7 +134,7 @@ public:
 
 protected:
 	void recalcFusion() {
-		fusion = Sensors::SensorFusion(
+		fusion = Fusion(
 			IMU::SensorVQFParams,
 			getGyroTimestep(),
 			getAccelTimestep(),
@@ -103,7 +142,7 @@ protected:
 		);
 	}
 
-	Sensors::SensorFusion& fusion;
+	Fusion& fusion;
 	IMU& sensor;
 	uint8_t sensorId;
 	SlimeVR::Logging::Logger& logger;
@@ -0,0 +1,57 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "motionprocessing/types.h"
+
+namespace SlimeVR::Sensors {
+
+// Structure-of-arrays buffer of three axis samples. Samples from one FIFO read are
+// collected here so that scaling and fusion can run over whole axes in tight loops
+// instead of once per sample.
+template <size_t Capacity>
+struct SampleBatch {
+	sensor_real_t x[Capacity];
+	sensor_real_t y[Capacity];
+	sensor_real_t z[Capacity];
+	sensor_real_t dt[Capacity];  // time since the previous sample
+	size_t count = 0;
+
+	template <typename RawSensorT>
+	void push(const RawSensorT xyz[3], sensor_real_t timeDelta) {
+		x[count] = static_cast<sensor_real_t>(xyz[0]);
+		y[count] = static_cast<sensor_real_t>(xyz[1]);
+		z[count] = static_cast<sensor_real_t>(xyz[2]);
+		dt[count] = timeDelta;
+		count++;
+	}
+
+	[[nodiscard]] bool full() const { return count == Capacity; }
+	void clear() { count = 0; }
+};
+
+}  // namespace SlimeVR::Sensors
@@ -23,14 +23,17 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <vector>
 
 #include "CalibrationBase.h"
 #include "GlobalVars.h"
 #include "configuration/SensorConfig.h"
 #include "logging/Logger.h"
+#include "magneto1.4.h"
 #include "motionprocessing/RestDetection.h"
 #include "motionprocessing/types.h"
 #include "sensors/SensorFusion.h"
@@ -46,9 +49,10 @@ public:
 	using Consts = typename Base::Consts;
 	using RawSensorT = typename Consts::RawSensorT;
 	using RawVectorT = typename Consts::RawVectorT;
+	using Fusion = typename Base::Fusion;
 
 	SoftfusionCalibrator(
-		Sensors::SensorFusion& fusion,
+		Fusion& fusion,
 		IMU& sensor,
 		uint8_t sensorId,
 		SlimeVR::Logging::Logger& logger,
@@ -58,112 +62,152 @@ public:
 		calibration.T_Ts = Consts::getDefaultTempTs();
 	}
 
-	void eatSamplesForSeconds(const uint32_t seconds) {
-		const auto targetDelay = millis() + 1000 * seconds;
-		auto lastSecondsRemaining = seconds;
-		while (millis() < targetDelay) {
-#ifdef ESP8266
-			ESP.wdtFeed();
-#endif
-			auto currentSecondsRemaining = (targetDelay - millis()) / 1000;
-			if (currentSecondsRemaining != lastSecondsRemaining) {
-				logger.info("%d...", currentSecondsRemaining + 1);
-				lastSecondsRemaining = currentSecondsRemaining;
-			}
+	// Only arms the flip gesture detection, the gesture itself is watched in tick()
+	// so boot and the other sensors aren't held up
+	void checkStartupCalibration() final {
+		startupFlipState = StartupFlipState::Settling;
+		startupFlipStateStartMillis = millis();
+	}
+
+	void provideAccelSample(const RawSensorT accelSample[3]) final {
+		lastGravity = static_cast<sensor_real_t>(
+			Consts::AScale * static_cast<sensor_real_t>(accelSample[2])
+		);
 
-			sensor.bulkRead({
-				[](const RawSensorT xyz[3], const sensor_real_t timeDelta) {},
-				[](const RawSensorT xyz[3], const sensor_real_t timeDelta) {},
-				[](const int16_t xyz, const sensor_real_t timeDelta) {},
-			});
+		if (routinePhase != RoutinePhase::Collecting) {
+			return;
+		}
+
+		if (currentRoutine == Routine::SampleRate) {
+			sampleRateData.accelSamples++;
+		} else if (currentRoutine == Routine::Accel) {
+			collectAccelSample(accelSample);
 		}
 	}
 
-	std::tuple<RawVectorT, RawVectorT, int16_t> eatSamplesReturnLast(
-		const uint32_t milliseconds
-	) {
-		RawVectorT accel = {0};
-		RawVectorT gyro = {0};
-		int16_t temp = 0;
-		const auto targetDelay = millis() + milliseconds;
-		while (millis() < targetDelay) {
-			sensor.bulkRead({
-				[&](const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-					accel[0] = xyz[0];
-					accel[1] = xyz[1];
-					accel[2] = xyz[2];
-				},
-				[&](const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-					gyro[0] = xyz[0];
-					gyro[1] = xyz[1];
-					gyro[2] = xyz[2];
-				},
-				[&](const int16_t rawTemp, const sensor_real_t timeDelta) {
-					temp = rawTemp;
-				},
-			});
-			yield();
-		}
-		return std::make_tuple(accel, gyro, temp);
+	void provideGyroSample(const RawSensorT gyroSample[3]) final {
+		if (routinePhase != RoutinePhase::Collecting) {
+			return;
+		}
+
+		if (currentRoutine == Routine::SampleRate) {
+			sampleRateData.gyroSamples++;
+		} else if (currentRoutine == Routine::GyroOffset) {
+			gyroOffsetData.sumXYZ[0] += gyroSample[0];
+			gyroOffsetData.sumXYZ[1] += gyroSample[1];
+			gyroOffsetData.sumXYZ[2] += gyroSample[2];
+			gyroOffsetData.sampleCount++;
+		}
 	}
 
-	void checkStartupCalibration() final {
-		auto lastRawSample = eatSamplesReturnLast(1000);
-		auto gravity = static_cast<sensor_real_t>(
-			Consts::AScale * static_cast<sensor_real_t>(std::get<0>(lastRawSample)[2])
-		);
-		logger.info("Gravity read: %.1f (need < -7.5 to start calibration)", gravity);
-		if (gravity > -7.5f) {
+	void provideTempSample(float tempSample) final {
+		lastTemperature = tempSample;
+
+		if (routinePhase == RoutinePhase::Collecting
+			&& currentRoutine == Routine::SampleRate) {
+			sampleRateData.tempSamples++;
+		}
+	}
+
+	void tick() final {
+		if (currentRoutine != Routine::None) {
+			tickRoutine();
 			return;
 		}
 
-		ledManager.on(CRGB::HTMLColorCode::Orange);
-		logger.info("Flip front in 5 seconds to start calibration");
-		lastRawSample = eatSamplesReturnLast(5000);
-		gravity = static_cast<sensor_real_t>(
-			Consts::AScale * static_cast<sensor_real_t>(std::get<0>(lastRawSample)[2])
-		);
-		if (gravity > 7.5f) {
-			logger.debug("Starting calibration...");
-			startCalibration(0);
-		} else {
-			logger.info("Flip not detected. Skipping calibration.");
+		if (startupFlipState == StartupFlipState::Done) {
+			return;
 		}
 
-		ledManager.off();
+		const uint32_t elapsed = millis() - startupFlipStateStartMillis;
+
+		switch (startupFlipState) {
+			case StartupFlipState::Settling:
+				if (elapsed < StartupSettleMillis) {
+					return;
+				}
+
+				logger.info(
+					"Gravity read: %.1f (need < -7.5 to start calibration)",
+					lastGravity
+				);
+				if (lastGravity > -7.5f) {
+					startupFlipState = StartupFlipState::Done;
+					return;
+				}
+
+				ledManager.on(CRGB::HTMLColorCode::Orange);
+				logger.info("Flip front in 5 seconds to start calibration");
+				startupFlipState = StartupFlipState::WaitingForFlip;
+				startupFlipStateStartMillis = millis();
+				flipSeenMillis = 0;
+				flipSeen = false;
+				return;
+			case StartupFlipState::WaitingForFlip:
+				// the tracker has to stay flipped for a moment, a tracker that is just
+				// being turned over isn't ready for calibration yet
+				if (lastGravity > 7.5f) {
+					if (!flipSeen) {
+						flipSeen = true;
+						flipSeenMillis = millis();
+					} else if (millis() - flipSeenMillis >= StartupFlipHoldMillis) {
+						ledManager.off();
+						startupFlipState = StartupFlipState::Done;
+						logger.debug("Starting calibration...");
+						startCalibration(0);
+						return;
+					}
+				} else {
+					flipSeen = false;
+				}
+
+				if (elapsed >= StartupFlipWindowMillis) {
+					logger.info("Flip not detected. Skipping calibration.");
+					ledManager.off();
+					startupFlipState = StartupFlipState::Done;
+				}
+				return;
+			case StartupFlipState::Done:
+				return;
+		}
 	}
 
+	// Only queues the routines, they run from tick() on the samples the sensor reads
+	// anyway, so the rest of the device keeps running while calibrating
 	void startCalibration(int calibrationType) final {
+		if (currentRoutine != Routine::None) {
+			logger.warn("Calibration already in progress");
+			return;
+		}
+
+		routineCount = 0;
+		routineIndex = 0;
 		if (calibrationType == 0) {
 			// ALL
-			calibrateSampleRate();
+			queueRoutine(Routine::SampleRate);
 			if constexpr (Base::HasMotionlessCalib) {
-				typename IMU::MotionlessCalibrationData calibData;
-				sensor.motionlessCalibration(calibData);
-				std::memcpy(calibration.MotionlessData, &calibData, sizeof(calibData));
+				queueRoutine(Routine::Motionless);
 			}
 			// Gryoscope offset calibration can only happen after any motionless
 			// gyroscope calibration, otherwise we are calculating the offset based
 			// on an incorrect starting point
-			calibrateGyroOffset();
-			calibrateAccel();
+			queueRoutine(Routine::GyroOffset);
+			queueRoutine(Routine::Accel);
 		} else if (calibrationType == 1) {
-			calibrateSampleRate();
+			queueRoutine(Routine::SampleRate);
 		} else if (calibrationType == 2) {
-			calibrateGyroOffset();
+			queueRoutine(Routine::GyroOffset);
 		} else if (calibrationType == 3) {
-			calibrateAccel();
+			queueRoutine(Routine::Accel);
 		} else if (calibrationType == 4) {
 			if constexpr (Base::HasMotionlessCalib) {
-				typename IMU::MotionlessCalibrationData calibData;
-				sensor.motionlessCalibration(calibData);
-				std::memcpy(calibration.MotionlessData, &calibData, sizeof(calibData));
+				queueRoutine(Routine::Motionless);
 			} else {
 				logger.info("Sensor doesn't provide any custom motionless calibration");
 			}
 		}
 
-		saveCalibration();
+		startNextRoutine();
 	}
 
 	bool calibrationMatches(
@@ -219,6 +263,46 @@ public:
 
 	float getAccelTimestep() final { return calibration.A_Ts; }
 
+	void scaleMagSample(sensor_real_t magSample[3]) final {
+		float tmp[3];
+		for (uint8_t i = 0; i < 3; i++) {
+			tmp[i] = (magSample[i] - calibration.M_B[i]);
+		}
+
+		magSample[0]
+			= (calibration.M_Ainv[0][0] * tmp[0] + calibration.M_Ainv[0][1] * tmp[1]
+			   + calibration.M_Ainv[0][2] * tmp[2]);
+		magSample[1]
+			= (calibration.M_Ainv[1][0] * tmp[0] + calibration.M_Ainv[1][1] * tmp[1]
+			   + calibration.M_Ainv[1][2] * tmp[2]);
+		magSample[2]
+			= (calibration.M_Ainv[2][0] * tmp[0] + calibration.M_Ainv[2][1] * tmp[1]
+			   + calibration.M_Ainv[2][2] * tmp[2]);
+	}
+
+	// Both the transparent default calibration and the zeroed out one used with
+	// calibration disabled mean the mag was never calibrated
+	bool hasMagCalibration() final {
+		bool transparent = true;
+		bool zeroed = true;
+		for (size_t i = 0; i < 3; i++) {
+			if (calibration.M_B[i] != 0) {
+				transparent = false;
+				zeroed = false;
+			}
+			for (size_t j = 0; j < 3; j++) {
+				const float identity = i == j ? 1.0f : 0.0f;
+				if (calibration.M_Ainv[i][j] != identity) {
+					transparent = false;
+				}
+				if (calibration.M_Ainv[i][j] != 0) {
+					zeroed = false;
+				}
+			}
+		}
+		return !transparent && !zeroed;
+	}
+
 	void scaleGyroSample(sensor_real_t gyroSample[3]) final {
 		gyroSample[0] = static_cast<sensor_real_t>(
 			Consts::GScale * (gyroSample[0] - calibration.G_off[0])
@@ -231,6 +315,45 @@ public:
 		);
 	}
 
+	void scaleAccelBatch(
+		sensor_real_t x[],
+		sensor_real_t y[],
+		sensor_real_t z[],
+		size_t count
+	) final {
+		const auto& Ainv = calibration.A_Ainv;
+		const sensor_real_t bx = calibration.A_B[0];
+		const sensor_real_t by = calibration.A_B[1];
+		const sensor_real_t bz = calibration.A_B[2];
+		for (size_t i = 0; i < count; i++) {
+			const sensor_real_t tx = x[i] - bx;
+			const sensor_real_t ty = y[i] - by;
+			const sensor_real_t tz = z[i] - bz;
+			x[i] = (Ainv[0][0] * tx + Ainv[0][1] * ty + Ainv[0][2] * tz)
+				 * Consts::AScale;
+			y[i] = (Ainv[1][0] * tx + Ainv[1][1] * ty + Ainv[1][2] * tz)
+				 * Consts::AScale;
+			z[i] = (Ainv[2][0] * tx + Ainv[2][1] * ty + Ainv[2][2] * tz)
+				 * Consts::AScale;
+		}
+	}
+
+	void scaleGyroBatch(
+		sensor_real_t x[],
+		sensor_real_t y[],
+		sensor_real_t z[],
+		size_t count
+	) final {
+		const sensor_real_t offX = calibration.G_off[0];
+		const sensor_real_t offY = calibration.G_off[1];
+		const sensor_real_t offZ = calibration.G_off[2];
+		for (size_t i = 0; i < count; i++) {
+			x[i] = Consts::GScale * (x[i] - offX);
+			y[i] = Consts::GScale * (y[i] - offY);
+			z[i] = Consts::GScale * (z[i] - offZ);
+		}
+	}
+
 	float getGyroTimestep() final { return calibration.G_Ts; }
 
 	float getTempTimestep() final { return calibration.T_Ts; }
@@ -240,6 +363,22 @@ public:
 	}
 
 private:
+	enum class StartupFlipState {
+		Settling,
+		WaitingForFlip,
+		Done,
+	};
+
+	static constexpr uint32_t StartupSettleMillis = 1000;
+	static constexpr uint32_t StartupFlipWindowMillis = 5000;
+	static constexpr uint32_t StartupFlipHoldMillis = 500;
+
+	StartupFlipState startupFlipState = StartupFlipState::Done;
+	uint32_t startupFlipStateStartMillis = 0;
+	bool flipSeen = false;
+	uint32_t flipSeenMillis = 0;
+	sensor_real_t lastGravity = 0;
+
 	static constexpr auto GyroCalibDelaySeconds = 5;
 	static constexpr auto GyroCalibSeconds = 5;
 
@@ -258,178 +397,339 @@ private:
 		configuration.save();
 	}
 
-	void calibrateGyroOffset() {
-		if (!toggles.getToggle(SensorToggles::CalibrationEnabled)) {
-			return;
-		}
+	enum class Routine {
+		None,
+		SampleRate,
+		Motionless,
+		GyroOffset,
+		Accel,
+	};
 
-		// Wait for sensor to calm down before calibration
-		logger.info(
-			"Put down the device and wait for baseline gyro reading calibration "
-			"(%d seconds)",
-			GyroCalibDelaySeconds
-		);
-		ledManager.on(CRGB::HTMLColorCode::Orange);
-		auto lastSamples = eatSamplesReturnLast(GyroCalibDelaySeconds);
-		ledManager.off();
+	enum class RoutinePhase {
+		// samples are thrown away while the user gets the device in position
+		Waiting,
+		Collecting,
+	};
 
-		calibration.temperature = std::get<2>(lastSamples) / IMU::TemperatureSensitivity
-								+ IMU::TemperatureBias;
-		logger.trace("Calibration temperature: %f", calibration.temperature);
+	static constexpr size_t MaxQueuedRoutines = 4;
+	std::array<Routine, MaxQueuedRoutines> queuedRoutines{};
+	size_t routineCount = 0;
+	size_t routineIndex = 0;
 
-		ledManager.pattern(100, 100, 3, CRGB::HTMLColorCode::Orange);
-		ledManager.on(CRGB::HTMLColorCode::Orange);
-		logger.info("Gyro calibration started...");
+	Routine currentRoutine = Routine::None;
+	RoutinePhase routinePhase = RoutinePhase::Waiting;
+	uint32_t phaseStartMillis = 0;
+	uint32_t phaseMillis = 0;
+	uint32_t lastSecondsRemaining = 0;
+	float lastTemperature = 0;
 
+	struct SampleRateData {
+		uint32_t accelSamples = 0;
+		uint32_t gyroSamples = 0;
+		uint32_t tempSamples = 0;
+	} sampleRateData;
+
+	struct GyroOffsetData {
 		int32_t sumXYZ[3] = {0};
-		const auto targetCalib = millis() + 1000 * GyroCalibSeconds;
 		uint32_t sampleCount = 0;
+	} gyroOffsetData;
+
+	static constexpr uint16_t AccelCalibPositions = 6;
+	static constexpr uint16_t AccelCalibSamplesPerPosition = 96;
+
+	struct AccelData {
+		std::unique_ptr<MagnetoCalibration> magneto;
+		std::unique_ptr<RestDetection> restDetection;
+		std::vector<float> chunk;
+		uint16_t numPositionsRecorded = 0;
+		uint16_t numCurrentPositionSamples = 0;
+		bool waitForMotion = true;
+	} accelData;
 
-		while (millis() < targetCalib) {
-#ifdef ESP8266
-			ESP.wdtFeed();
-#endif
-			sensor.bulkRead({
-				[](const RawSensorT xyz[3], const sensor_real_t timeDelta) {},
-				[&sumXYZ,
-				 &sampleCount](const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-					sumXYZ[0] += xyz[0];
-					sumXYZ[1] += xyz[1];
-					sumXYZ[2] += xyz[2];
-					++sampleCount;
-				},
-				[](const int16_t rawTemp, const sensor_real_t timeDelta) {},
-			});
+	void queueRoutine(Routine routine) { queuedRoutines[routineCount++] = routine; }
+
+	void startPhase(RoutinePhase phase, uint32_t seconds) {
+		routinePhase = phase;
+		phaseStartMillis = millis();
+		phaseMillis = 1000 * seconds;
+		lastSecondsRemaining = seconds;
+	}
+
+	bool phaseElapsed() const { return millis() - phaseStartMillis >= phaseMillis; }
+
+	void logCountdown() {
+		const uint32_t elapsed = millis() - phaseStartMillis;
+		if (elapsed >= phaseMillis) {
+			return;
 		}
 
-		ledManager.off();
-		calibration.G_off[0]
-			= static_cast<float>(sumXYZ[0]) / static_cast<float>(sampleCount);
-		calibration.G_off[1]
-			= static_cast<float>(sumXYZ[1]) / static_cast<float>(sampleCount);
-		calibration.G_off[2]
-			= static_cast<float>(sumXYZ[2]) / static_cast<float>(sampleCount);
+		const uint32_t secondsRemaining = (phaseMillis - elapsed) / 1000;
+		if (secondsRemaining != lastSecondsRemaining) {
+			logger.info("%d...", secondsRemaining + 1);
+			lastSecondsRemaining = secondsRemaining;
+		}
+	}
 
-		logger.info(
-			"Gyro offset after %d samples: %f %f %f",
-			sampleCount,
-			UNPACK_VECTOR_ARRAY(calibration.G_off)
-		);
+	void startNextRoutine() {
+		while (routineIndex < routineCount) {
+			currentRoutine = queuedRoutines[routineIndex++];
+			if (startRoutine()) {
+				return;
+			}
+		}
+
+		currentRoutine = Routine::None;
+		if (routineCount > 0) {
+			routineCount = 0;
+			saveCalibration();
+		}
 	}
 
-	void calibrateAccel() {
-		if (!toggles.getToggle(SensorToggles::CalibrationEnabled)) {
+	// Returns false if the routine is already done
+	bool startRoutine() {
+		switch (currentRoutine) {
+			case Routine::SampleRate:
+				logger.debug(
+					"Calibrating IMU sample rate in %d second(s)...",
+					SampleRateCalibDelaySeconds
+				);
+				ledManager.on(CRGB::HTMLColorCode::Orange);
+				startPhase(RoutinePhase::Waiting, SampleRateCalibDelaySeconds);
+				return true;
+			case Routine::Motionless:
+				if constexpr (Base::HasMotionlessCalib) {
+					// the driver runs this on its own, there is no way around blocking
+					typename IMU::MotionlessCalibrationData calibData;
+					sensor.motionlessCalibration(calibData);
+					std::memcpy(
+						calibration.MotionlessData,
+						&calibData,
+						sizeof(calibData)
+					);
+				}
+				return false;
+			case Routine::GyroOffset:
+				if (!toggles.getToggle(SensorToggles::CalibrationEnabled)) {
+					return false;
+				}
+
+				// Wait for sensor to calm down before calibration
+				logger.info(
+					"Put down the device and wait for baseline gyro reading "
+					"calibration (%d seconds)",
+					GyroCalibDelaySeconds
+				);
+				ledManager.on(CRGB::HTMLColorCode::Orange);
+				startPhase(RoutinePhase::Waiting, GyroCalibDelaySeconds);
+				return true;
+			case Routine::Accel:
+				if (!toggles.getToggle(SensorToggles::CalibrationEnabled)) {
+					return false;
+				}
+
+				logger.info(
+					"Put the device into 6 unique orientations (all sides), leave it "
+					"still and do not hold/touch for %d seconds each",
+					AccelCalibRestSeconds
+				);
+				ledManager.on(CRGB::HTMLColorCode::Orange);
+				startPhase(RoutinePhase::Waiting, AccelCalibDelaySeconds);
+				return true;
+			case Routine::None:
+				return false;
+		}
+		return false;
+	}
+
+	void tickRoutine() {
+		if (routinePhase == RoutinePhase::Waiting) {
+			logCountdown();
+			if (!phaseElapsed()) {
+				return;
+			}
+
+			startCollecting();
 			return;
 		}
 
-		auto magneto = std::make_unique<MagnetoCalibration>();
-		logger.info(
-			"Put the device into 6 unique orientations (all sides), leave it still "
-			"and do not hold/touch for %d seconds each",
-			AccelCalibRestSeconds
-		);
-		ledManager.on(CRGB::HTMLColorCode::Orange);
-		eatSamplesForSeconds(AccelCalibDelaySeconds);
-		ledManager.off();
+		bool done = false;
+		switch (currentRoutine) {
+			case Routine::SampleRate:
+			case Routine::GyroOffset:
+				done = phaseElapsed();
+				break;
+			case Routine::Accel:
+				done = accelData.numPositionsRecorded >= AccelCalibPositions;
+				break;
+			case Routine::Motionless:
+			case Routine::None:
+				done = true;
+				break;
+		}
 
-		RestDetectionParams calibrationRestDetectionParams;
-		calibrationRestDetectionParams.restMinTime = AccelCalibRestSeconds;
-		calibrationRestDetectionParams.restThAcc = 0.25f;
+		if (!done) {
+			return;
+		}
 
-		RestDetection calibrationRestDetection(
-			calibrationRestDetectionParams,
-			IMU::GyrTs,
-			IMU::AccTs
-		);
+		finishRoutine();
+		startNextRoutine();
+	}
 
-		constexpr uint16_t expectedPositions = 6;
-		constexpr uint16_t numSamplesPerPosition = 96;
+	void startCollecting() {
+		switch (currentRoutine) {
+			case Routine::SampleRate:
+				logger.debug("Counting samples now...");
+				sampleRateData = {};
+				startPhase(RoutinePhase::Collecting, SampleRateCalibSeconds);
+				break;
+			case Routine::GyroOffset:
+				ledManager.off();
+
+				calibration.temperature = lastTemperature;
+				logger.trace("Calibration temperature: %f", calibration.temperature);
+
+				ledManager.pattern(100, 100, 3, CRGB::HTMLColorCode::Orange);
+				ledManager.on(CRGB::HTMLColorCode::Orange);
+				logger.info("Gyro calibration started...");
+				gyroOffsetData = {};
+				startPhase(RoutinePhase::Collecting, GyroCalibSeconds);
+				break;
+			case Routine::Accel: {
+				ledManager.off();
+
+				RestDetectionParams calibrationRestDetectionParams;
+				calibrationRestDetectionParams.restMinTime = AccelCalibRestSeconds;
+				calibrationRestDetectionParams.restThAcc = 0.25f;
+
+				accelData.magneto = std::make_unique<MagnetoCalibration>();
+				accelData.restDetection = std::make_unique<RestDetection>(
+					calibrationRestDetectionParams,
+					IMU::GyrTs,
+					IMU::AccTs
+				);
+				accelData.chunk.resize(AccelCalibSamplesPerPosition * 3);
+				accelData.numPositionsRecorded = 0;
+				accelData.numCurrentPositionSamples = 0;
+				accelData.waitForMotion = true;
+
+				ledManager.pattern(100, 100, 6, CRGB::HTMLColorCode::Orange);
+				ledManager.on(CRGB::HTMLColorCode::Orange);
+				logger.info("Gathering accelerometer data...");
+				logger.info(
+					"Waiting for position %i, you can leave the device as is...",
+					accelData.numPositionsRecorded + 1
+				);
+				startPhase(RoutinePhase::Collecting, 0);
+				break;
+			}
+			case Routine::Motionless:
+			case Routine::None:
+				break;
+		}
+	}
 
-		uint16_t numPositionsRecorded = 0;
-		uint16_t numCurrentPositionSamples = 0;
-		bool waitForMotion = true;
+	void collectAccelSample(const RawSensorT xyz[3]) {
+		if (accelData.numPositionsRecorded >= AccelCalibPositions) {
+			return;
+		}
 
-		std::vector<float> accelCalibrationChunk;
-		accelCalibrationChunk.resize(numSamplesPerPosition * 3);
-		ledManager.pattern(100, 100, 6, CRGB::HTMLColorCode::Orange);
-		ledManager.on(CRGB::HTMLColorCode::Orange);
-		logger.info("Gathering accelerometer data...");
-		logger.info(
-			"Waiting for position %i, you can leave the device as is...",
-			numPositionsRecorded + 1
-		);
-		bool samplesGathered = false;
-		while (!samplesGathered) {
-#ifdef ESP8266
-			ESP.wdtFeed();
-#endif
-			sensor.bulkRead({
-				[&](const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-					const sensor_real_t scaledData[]
-						= {static_cast<sensor_real_t>(
-							   Consts::AScale * static_cast<sensor_real_t>(xyz[0])
-						   ),
-						   static_cast<sensor_real_t>(
-							   Consts::AScale * static_cast<sensor_real_t>(xyz[1])
-						   ),
-						   static_cast<sensor_real_t>(
-							   Consts::AScale * static_cast<sensor_real_t>(xyz[2])
-						   )};
-
-					calibrationRestDetection.updateAcc(IMU::AccTs, scaledData);
-					if (waitForMotion) {
-						if (!calibrationRestDetection.getRestDetected()) {
-							waitForMotion = false;
-						}
-						return;
-					}
+		const sensor_real_t scaledData[]
+			= {static_cast<sensor_real_t>(
+				   Consts::AScale * static_cast<sensor_real_t>(xyz[0])
+			   ),
+			   static_cast<sensor_real_t>(
+				   Consts::AScale * static_cast<sensor_real_t>(xyz[1])
+			   ),
+			   static_cast<sensor_real_t>(
+				   Consts::AScale * static_cast<sensor_real_t>(xyz[2])
+			   )};
+
+		auto& restDetection = *accelData.restDetection;
+		restDetection.updateAcc(IMU::AccTs, scaledData);
+		if (accelData.waitForMotion) {
+			if (!restDetection.getRestDetected()) {
+				accelData.waitForMotion = false;
+			}
+			return;
+		}
 
-					if (calibrationRestDetection.getRestDetected()) {
-						const uint16_t i = numCurrentPositionSamples * 3;
-						accelCalibrationChunk[i + 0] = xyz[0];
-						accelCalibrationChunk[i + 1] = xyz[1];
-						accelCalibrationChunk[i + 2] = xyz[2];
-						numCurrentPositionSamples++;
-
-						if (numCurrentPositionSamples >= numSamplesPerPosition) {
-							for (int i = 0; i < numSamplesPerPosition; i++) {
-								magneto->sample(
-									accelCalibrationChunk[i * 3 + 0],
-									accelCalibrationChunk[i * 3 + 1],
-									accelCalibrationChunk[i * 3 + 2]
-								);
-							}
-							numPositionsRecorded++;
-							numCurrentPositionSamples = 0;
-							if (numPositionsRecorded < expectedPositions) {
-								ledManager
-									.pattern(50, 50, 2, CRGB::HTMLColorCode::Orange);
-								ledManager.on(CRGB::HTMLColorCode::Orange);
-								logger.info(
-									"Recorded, waiting for position %i...",
-									numPositionsRecorded + 1
-								);
-								waitForMotion = true;
-							}
-						}
-					} else {
-						numCurrentPositionSamples = 0;
-					}
+		if (!restDetection.getRestDetected()) {
+			accelData.numCurrentPositionSamples = 0;
+			return;
+		}
 
-					if (numPositionsRecorded >= expectedPositions) {
-						samplesGathered = true;
-					}
-				},
-				[](const RawSensorT xyz[3], const sensor_real_t timeDelta) {},
-				[](const int16_t rawTemp, const sensor_real_t timeDelta) {},
-			});
+		const uint16_t i = accelData.numCurrentPositionSamples * 3;
+		accelData.chunk[i + 0] = xyz[0];
+		accelData.chunk[i + 1] = xyz[1];
+		accelData.chunk[i + 2] = xyz[2];
+		accelData.numCurrentPositionSamples++;
+
+		if (accelData.numCurrentPositionSamples < AccelCalibSamplesPerPosition) {
+			return;
+		}
+
+		for (int i = 0; i < AccelCalibSamplesPerPosition; i++) {
+			accelData.magneto->sample(
+				accelData.chunk[i * 3 + 0],
+				accelData.chunk[i * 3 + 1],
+				accelData.chunk[i * 3 + 2]
+			);
+		}
+		accelData.numPositionsRecorded++;
+		accelData.numCurrentPositionSamples = 0;
+		if (accelData.numPositionsRecorded < AccelCalibPositions) {
+			ledManager.pattern(50, 50, 2, CRGB::HTMLColorCode::Orange);
+			ledManager.on(CRGB::HTMLColorCode::Orange);
+			logger.info(
+				"Recorded, waiting for position %i...",
+				accelData.numPositionsRecorded + 1
+			);
+			accelData.waitForMotion = true;
+		}
+	}
+
+	void finishRoutine() {
+		switch (currentRoutine) {
+			case Routine::SampleRate:
+				finishSampleRate();
+				break;
+			case Routine::GyroOffset:
+				finishGyroOffset();
+				break;
+			case Routine::Accel:
+				finishAccel();
+				break;
+			case Routine::Motionless:
+			case Routine::None:
+				break;
+		}
+		routinePhase = RoutinePhase::Waiting;
+	}
+
+	void finishGyroOffset() {
+		ledManager.off();
+		const auto sampleCount = static_cast<float>(gyroOffsetData.sampleCount);
+		for (size_t i = 0; i < 3; i++) {
+			calibration.G_off[i]
+				= static_cast<float>(gyroOffsetData.sumXYZ[i]) / sampleCount;
 		}
+
+		logger.info(
+			"Gyro offset after %d samples: %f %f %f",
+			gyroOffsetData.sampleCount,
+			UNPACK_VECTOR_ARRAY(calibration.G_off)
+		);
+	}
+
+	void finishAccel() {
 		ledManager.off();
 		logger.debug("Calculating accelerometer calibration data...");
-		accelCalibrationChunk.resize(0);
+		accelData.chunk.resize(0);
 
 		float A_BAinv[4][3];
-		magneto->current_calibration(A_BAinv);
+		accelData.magneto->current_calibration(A_BAinv);
+		accelData.magneto.reset();
+		accelData.restDetection.reset();
 
 		logger.debug("Finished calculating accelerometer calibration");
 		logger.debug("Accelerometer calibration matrix:");
@@ -450,51 +750,20 @@ private:
 		logger.debug("}");
 	}
 
-	void calibrateSampleRate() {
-		logger.debug(
-			"Calibrating IMU sample rate in %d second(s)...",
-			SampleRateCalibDelaySeconds
-		);
-		ledManager.on(CRGB::HTMLColorCode::Orange);
-		eatSamplesForSeconds(SampleRateCalibDelaySeconds);
-
-		uint32_t accelSamples = 0;
-		uint32_t gyroSamples = 0;
-		uint32_t tempSamples = 0;
-
-		const auto calibTarget = millis() + 1000 * SampleRateCalibSeconds;
-		logger.debug("Counting samples now...");
-		uint32_t currentTime;
-		while ((currentTime = millis()) < calibTarget) {
-			sensor.bulkRead({
-				[&](const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-					accelSamples++;
-				},
-				[&](const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-					gyroSamples++;
-				},
-				[&](const int16_t rawTemp, const sensor_real_t timeDelta) {
-					tempSamples++;
-				},
-			});
-			yield();
-		}
-
-		const auto millisFromStart = static_cast<float>(
-			currentTime - (calibTarget - 1000 * SampleRateCalibSeconds)
-		);
+	void finishSampleRate() {
+		const auto millisFromStart = static_cast<float>(millis() - phaseStartMillis);
 		logger.debug(
 			"Collected %d gyro, %d acc samples during %d ms",
-			gyroSamples,
-			accelSamples,
-			millisFromStart
+			sampleRateData.gyroSamples,
+			sampleRateData.accelSamples,
+			static_cast<int>(millisFromStart)
 		);
-		calibration.A_Ts
-			= millisFromStart / (static_cast<float>(accelSamples) * 1000.0f);
-		calibration.G_Ts
-			= millisFromStart / (static_cast<float>(gyroSamples) * 1000.0f);
-		calibration.T_Ts
-			= millisFromStart / (static_cast<float>(tempSamples) * 1000.0f);
+		calibration.A_Ts = millisFromStart
+						 / (static_cast<float>(sampleRateData.accelSamples) * 1000.0f);
+		calibration.G_Ts = millisFromStart
+						 / (static_cast<float>(sampleRateData.gyroSamples) * 1000.0f);
+		calibration.T_Ts = millisFromStart
+						 / (static_cast<float>(sampleRateData.tempSamples) * 1000.0f);
 
 		logger.debug(
 			"Gyro frequency %fHz, accel frequency: %fHz, temperature frequency: "
@@ -30,6 +30,7 @@
 #include <limits>
 
 #include "../../../sensorinterface/RegisterInterface.h"
+#include "../../FifoHealth.h"
 #include "callbacks.h"
 #include "vqf.h"
 
@@ -112,8 +113,36 @@ struct BMI160 {
 		static constexpr uint8_t FifoLength = 0x22;
 		static constexpr uint8_t FifoData = 0x24;
 		static constexpr uint8_t ErrReg = 0x02;
+
+		static constexpr uint8_t FifoWatermark = 0x46;  // in units of 4 bytes
+
+		struct IntEn1 {
+			static constexpr uint8_t reg = 0x51;
+			static constexpr uint8_t value = (1 << 6);  // fifo watermark interrupt
+		};
+
+		struct IntOutCtrl {
+			static constexpr uint8_t reg = 0x53;
+			static constexpr uint8_t value
+				= (1 << 1) | (0 << 2) | (1 << 3);  // active high, push-pull, output en
+		};
+
+		struct IntLatch {
+			static constexpr uint8_t reg = 0x54;
+			static constexpr uint8_t value = 0x0;  // non latched
+		};
+
+		struct IntMap1 {
+			static constexpr uint8_t reg = 0x56;
+			static constexpr uint8_t value = (1 << 6);  // fifo watermark on INT1
+		};
 	};
 
+	// The interrupt fires once the fill level goes above the watermark. At 200Hz gyro
+	// and 100Hz accel a 10ms pair of header frames is 13 + 7 bytes, so set it one
+	// 4 byte unit below that
+	static constexpr uint16_t FifoWatermarkBytes = 16;
+
 	struct Fifo {
 		static constexpr uint8_t ModeMask = 0b11000000;
 		static constexpr uint8_t SkipFrame = 0b01000000;
@@ -123,9 +152,22 @@ struct BMI160 {
 		static constexpr uint8_t AccelDataBit = 0b00000100;
 	};
 
-	bool initialize() {
+	// Returns how long to wait before initialize()
+	uint32_t startReset() {
 		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueSoftReset);
-		delay(12);
+		return 12;
+	}
+
+	static constexpr uint32_t PowerUpMillis = 100;
+
+	bool initialize() {
+		delay(startInitialize());
+		return finishInitialize();
+	}
+
+	// initialize() split at the gyro power up wait, returns how long to wait before
+	// finishInitialize()
+	uint32_t startInitialize() {
 		m_RegisterInterface.writeReg(Regs::AccelConf::reg, Regs::AccelConf::value);
 		delay(1);
 		m_RegisterInterface.writeReg(Regs::AccelRange::reg, Regs::AccelRange::value);
@@ -137,13 +179,21 @@ struct BMI160 {
 		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueAccPowerNormal);
 		delay(10);
 		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueGyrPowerNormal);
-		delay(100);
+		return PowerUpMillis;
+	}
+
+	bool finishInitialize() {
 		m_RegisterInterface.writeReg(Regs::FifoConfig::reg, Regs::FifoConfig::value);
 		delay(4);
 		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueFifoFlush);
 		delay(2);  // delay values ripped straight from old BMI160 driver, could maybe
 				   // be lower?
 
+		// soft resets (motionless calibration) wipe the interrupt config
+		if (m_fifoInterruptEnabled) {
+			enableFifoInterrupt();
+		}
+
 		if (m_RegisterInterface.readReg(Regs::ErrReg) != 0) {
 			m_Logger.error(
 				"BMI160 error: 0x%x",
@@ -155,6 +205,17 @@ struct BMI160 {
 		}
 	}
 
+	bool m_fifoInterruptEnabled = false;
+
+	void enableFifoInterrupt() {
+		m_RegisterInterface.writeReg(Regs::FifoWatermark, FifoWatermarkBytes / 4);
+		m_RegisterInterface.writeReg(Regs::IntLatch::reg, Regs::IntLatch::value);
+		m_RegisterInterface.writeReg(Regs::IntOutCtrl::reg, Regs::IntOutCtrl::value);
+		m_RegisterInterface.writeReg(Regs::IntMap1::reg, Regs::IntMap1::value);
+		m_RegisterInterface.writeReg(Regs::IntEn1::reg, Regs::IntEn1::value);
+		m_fifoInterruptEnabled = true;
+	}
+
 	float getDirectTemp() const {
 		// 0x0 is 23C
 		// Resolution is 1/2^9 K / LSB
@@ -166,6 +227,9 @@ struct BMI160 {
 	using FifoBuffer = std::array<uint8_t, RegisterInterface::MaxTransactionLength>;
 	FifoBuffer read_buffer;
 
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+
 	template <typename T>  // sorry tailsy I ripped all of this from BMI270 driver
 						   // because I don't even want to try and understand the FIFO
 						   // format
@@ -176,8 +240,10 @@ struct BMI160 {
 		return to_ret;
 	}
 
-	void bulkRead(DriverCallbacks<int16_t>&& callbacks) {
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int16_t, Callbacks...>&& callbacks) {
 		const auto fifo_bytes = m_RegisterInterface.readReg16(Regs::FifoLength) & 0x7FF;
+		m_fifoHealth.recordFillLevel(fifo_bytes);
 
 		const auto bytes_to_read = std::min(
 			static_cast<size_t>(read_buffer.size()),
@@ -193,7 +259,12 @@ struct BMI160 {
 					// incomplete frame, nothing left to process
 					break;
 				}
-				getFromFifo<uint8_t>(i, read_buffer);  // skip 1 byte
+				// the payload is the amount of frames dropped due to an overrun
+				const auto skipped = getFromFifo<uint8_t>(i, read_buffer);
+				if (header == Fifo::SkipFrame) {
+					m_fifoHealth.overruns++;
+					m_fifoHealth.skippedFrames += skipped;
+				}
 			} else if ((header & Fifo::ModeMask) == Fifo::DataFrame) {
 				uint8_t gyro_data_length = header & Fifo::GyrDataBit ? 6 : 0;
 				uint8_t accel_data_length = header & Fifo::AccelDataBit ? 6 : 0;
@@ -217,6 +288,12 @@ struct BMI160 {
 					accel[2] = getFromFifo<uint16_t>(i, read_buffer);
 					callbacks.processAccelSample(accel, AccTs);
 				}
+			} else {
+				// no other frame types are enabled, we lost track of the frames
+				m_Logger.warn("Corrupted FIFO frame, flushing FIFO");
+				m_fifoHealth.recordCorruption(bytes_to_read - i);
+				m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueFifoFlush);
+				return;
 			}
 		}
 	}
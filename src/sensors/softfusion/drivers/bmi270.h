@@ -28,9 +28,11 @@
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <vector>
 
 #include "../../../sensorinterface/RegisterInterface.h"
 #include "bmi270fw.h"
+#include "../../FifoHealth.h"
 #include "callbacks.h"
 #include "vqf.h"
 
@@ -110,6 +112,8 @@ struct BMI270 {
 		struct InternalStatus {
 			static constexpr uint8_t reg = 0x21;
 			static constexpr uint8_t initializedBit = 0x01;
+			static constexpr uint8_t messageMask = 0x0f;
+			static constexpr uint8_t messageInitOk = 0x01;
 		};
 
 		struct GyrConf {
@@ -226,6 +230,24 @@ struct BMI270 {
 		static constexpr uint8_t FifoCount = 0x24;
 		static constexpr uint8_t FifoData = 0x26;
 		static constexpr uint8_t RaGyrCas = 0x3c;  // on feature page 0!
+
+		static constexpr uint8_t FifoWatermark = 0x46;  // 13 bits, in bytes
+
+		struct Int1IoCtrl {
+			static constexpr uint8_t reg = 0x53;
+			static constexpr uint8_t value
+				= (1 << 1) | (0 << 2) | (1 << 3);  // active high, push-pull, output en
+		};
+
+		struct IntLatch {
+			static constexpr uint8_t reg = 0x55;
+			static constexpr uint8_t value = 0x0;  // non latched
+		};
+
+		struct IntMapData {
+			static constexpr uint8_t reg = 0x58;
+			static constexpr uint8_t value = (1 << 1);  // fifo watermark on INT1
+		};
 	};
 
 	struct Fifo {
@@ -237,45 +259,156 @@ struct BMI270 {
 		static constexpr uint8_t AccelDataBit = 0b00000100;
 	};
 
-	bool restartAndInit() {
-		// perform initialization step
-		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueSwReset);
-		delay(12);
-		// disable power saving
+	// the datasheet asks for 140ms, poll so we don't wait longer than needed
+	static constexpr uint32_t InitTimeoutMillis = 150;
+
+	bool isConfigLoaded() {
+		return (m_RegisterInterface.readReg(Regs::InternalStatus::reg)
+				& Regs::InternalStatus::messageMask)
+			== Regs::InternalStatus::messageInitOk;
+	}
+
+	// The config file survives an MCU reset as long as the IMU stays powered, in
+	// that case the soft reset and the upload can be skipped. CRT needs a clean
+	// state, so it forces the upload.
+	bool warmStart() {
+		if (!isConfigLoaded()
+			|| m_RegisterInterface.readReg(Regs::GyrCrtConf::reg)
+				   == Regs::GyrCrtConf::valueRunning) {
+			return false;
+		}
+
+		m_Logger.debug("Config file already loaded, skipping upload");
+
+		// undo what the previous run may have left behind that setNormalConfig
+		// doesn't overwrite
+		m_RegisterInterface.writeReg(Regs::FeatPage, 0);
+		m_RegisterInterface.writeReg(Regs::Offset6::reg, 0);
 		m_RegisterInterface.writeReg(
 			Regs::PwrConf::reg,
-			Regs::PwrConf::valueNoPowerSaving
+			Regs::PwrConf::valueFifoSelfWakeup
 		);
-		delay(1);
 
-		// firmware upload
-		m_RegisterInterface.writeReg(
-			Regs::InitCtrl::reg,
-			Regs::InitCtrl::valueStartInit
+		readZxFactor();
+		return true;
+	}
+
+	void readZxFactor() {
+		// read zx factor used to reduce gyro cross-sensitivity error
+		const uint8_t zx_factor_reg = m_RegisterInterface.readReg(Regs::RaGyrCas);
+		const uint8_t sign_byte = (zx_factor_reg << 1) & 0x80;
+		m_zxFactor = static_cast<int8_t>(zx_factor_reg | sign_byte);
+	}
+
+	// the nominal time the config file takes to load
+	static constexpr uint32_t ConfigLoadMillis = 140;
+	static constexpr uint32_t SoftResetMicros = 12000;
+	static constexpr uint32_t PowerSaveOffMicros = 1000;
+	static constexpr uint32_t PowerUpMillis = 100;
+
+	bool m_configUploadPending = false;
+	uint32_t m_configUploadStartMillis = 0;
+
+	// The upload is written a chunk at a time by continueConfigUpload(), so the other
+	// sensors get the bus and the CPU in between
+	enum class ConfigUploadStep {
+		SoftReset,
+		DisablePowerSave,
+		WriteChunks,
+		Done,
+	};
+	ConfigUploadStep m_configUploadStep = ConfigUploadStep::Done;
+	uint32_t m_configUploadStepMicros = 0;
+	uint16_t m_configUploadPosition = 0;
+	std::vector<uint8_t> m_configUploadChunk;
+
+	void startConfigUpload() {
+		// perform initialization step
+		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueSwReset);
+		m_configUploadStep = ConfigUploadStep::SoftReset;
+		m_configUploadStepMicros = micros();
+	}
+
+	// Returns true once the whole config file is written
+	bool continueConfigUpload() {
+		switch (m_configUploadStep) {
+			case ConfigUploadStep::SoftReset:
+				if (micros() - m_configUploadStepMicros < SoftResetMicros) {
+					return false;
+				}
+				// disable power saving
+				m_RegisterInterface.writeReg(
+					Regs::PwrConf::reg,
+					Regs::PwrConf::valueNoPowerSaving
+				);
+				m_configUploadStep = ConfigUploadStep::DisablePowerSave;
+				m_configUploadStepMicros = micros();
+				return false;
+			case ConfigUploadStep::DisablePowerSave:
+				if (micros() - m_configUploadStepMicros < PowerSaveOffMicros) {
+					return false;
+				}
+				// firmware upload
+				m_RegisterInterface.writeReg(
+					Regs::InitCtrl::reg,
+					Regs::InitCtrl::valueStartInit
+				);
+				m_configUploadPosition = 0;
+				m_configUploadStep = ConfigUploadStep::WriteChunks;
+				return false;
+			case ConfigUploadStep::WriteChunks:
+				writeConfigChunk();
+				if (m_configUploadPosition < sizeof(bmi270_firmware)) {
+					return false;
+				}
+				m_configUploadChunk.clear();
+				m_configUploadChunk.shrink_to_fit();
+				m_RegisterInterface.writeReg(
+					Regs::InitCtrl::reg,
+					Regs::InitCtrl::valueEndInit
+				);
+				m_configUploadStartMillis = millis();
+				m_configUploadStep = ConfigUploadStep::Done;
+				return true;
+			case ConfigUploadStep::Done:
+				return true;
+		}
+		return true;
+	}
+
+	void writeConfigChunk() {
+		// positions are in words, so chunks have to stay even sized
+		const size_t maxBurstWrite
+			= std::min(m_RegisterInterface.getMaxTransactionLength(), size_t{0xff})
+			& ~size_t{1};
+		m_configUploadChunk.resize(maxBurstWrite);
+
+		// tell the device current position
+
+		// this thing is little endian, but it requires address in bizzare form
+		// LSB register is only 4 bits, while MSB register is 8bits
+		// also value requested is in words (16bit) not in bytes (8bit)
+
+		const uint16_t pos = m_configUploadPosition;
+		const uint16_t pos_words = pos >> 1;  // convert current position to words
+		const uint16_t position = (pos_words & 0x0F) | ((pos_words << 4) & 0xff00);
+		m_RegisterInterface.writeReg16(Regs::InitAddr, position);
+		// write actual payload chunk
+		const uint16_t burstWrite = std::min(
+			static_cast<size_t>(sizeof(bmi270_firmware) - pos),
+			maxBurstWrite
 		);
-		auto* firmware_buffer = new uint8_t[RegisterInterface::MaxTransactionLength];
-		for (uint16_t pos = 0; pos < sizeof(bmi270_firmware);) {
-			// tell the device current position
-
-			// this thing is little endian, but it requires address in bizzare form
-			// LSB register is only 4 bits, while MSB register is 8bits
-			// also value requested is in words (16bit) not in bytes (8bit)
-
-			const uint16_t pos_words = pos >> 1;  // convert current position to words
-			const uint16_t position = (pos_words & 0x0F) | ((pos_words << 4) & 0xff00);
-			m_RegisterInterface.writeReg16(Regs::InitAddr, position);
-			// write actual payload chunk
-			const uint16_t burstWrite = std::min(
-				static_cast<size_t>(sizeof(bmi270_firmware) - pos),
-				RegisterInterface::MaxTransactionLength
-			);
-			memcpy_P(firmware_buffer, bmi270_firmware + pos, burstWrite);
-			m_RegisterInterface.writeBytes(Regs::InitData, burstWrite, firmware_buffer);
-			pos += burstWrite;
+		memcpy_P(m_configUploadChunk.data(), bmi270_firmware + pos, burstWrite);
+		m_RegisterInterface
+			.writeBytes(Regs::InitData, burstWrite, m_configUploadChunk.data());
+		m_configUploadPosition += burstWrite;
+	}
+
+	bool finishConfigUpload() {
+		while (!isConfigLoaded()
+			   && millis() - m_configUploadStartMillis < InitTimeoutMillis) {
+			delay(1);
 		}
-		delete[] firmware_buffer;
-		m_RegisterInterface.writeReg(Regs::InitCtrl::reg, Regs::InitCtrl::valueEndInit);
-		delay(140);
 
 		// leave fifo_self_wakeup enabled
 		m_RegisterInterface.writeReg(
@@ -289,14 +422,44 @@ struct BMI270 {
 			return false;
 		}
 
-		// read zx factor used to reduce gyro cross-sensitivity error
-		const uint8_t zx_factor_reg = m_RegisterInterface.readReg(Regs::RaGyrCas);
-		const uint8_t sign_byte = (zx_factor_reg << 1) & 0x80;
-		m_zxFactor = static_cast<int8_t>(zx_factor_reg | sign_byte);
+		readZxFactor();
 		return true;
 	}
 
+	bool restartAndInit(bool forceUpload = false) {
+		if (!forceUpload && warmStart()) {
+			return true;
+		}
+
+		startConfigUpload();
+		while (!continueConfigUpload()) {
+			yield();
+		}
+		return finishConfigUpload();
+	}
+
+	// The config file is written by continueReset() and loads while other sensors
+	// are being reset, initialize() finishes the upload
+	uint32_t startReset() {
+		if (warmStart()) {
+			m_configUploadPending = false;
+			return 0;
+		}
+
+		startConfigUpload();
+		m_configUploadPending = true;
+		return ConfigLoadMillis;
+	}
+
+	bool continueReset() { return continueConfigUpload(); }
+
 	void setNormalConfig(MotionlessCalibrationData& gyroSensitivity) {
+		delay(startNormalConfig(gyroSensitivity));
+		finishNormalConfig();
+	}
+
+	// Returns how long the sensors take to power up before finishNormalConfig()
+	uint32_t startNormalConfig(MotionlessCalibrationData& gyroSensitivity) {
 		m_RegisterInterface.writeReg(Regs::GyrConf::reg, Regs::GyrConf::value);
 		m_RegisterInterface.writeReg(Regs::GyrRange::reg, Regs::GyrRange::value);
 
@@ -312,29 +475,72 @@ struct BMI270 {
 			Regs::PwrCtrl::reg,
 			Regs::PwrCtrl::valueGyrAccTempOn
 		);
-		delay(100);  // power up delay
+		return PowerUpMillis;
+	}
+
+	void finishNormalConfig() {
 		m_RegisterInterface.writeReg(Regs::FifoConfig0::reg, Regs::FifoConfig0::value);
 		m_RegisterInterface.writeReg(Regs::FifoConfig1::reg, Regs::FifoConfig1::value);
 
 		delay(4);
 		m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueFifoFlush);
 		delay(2);
+
+		// soft resets (motionless calibration) wipe the interrupt config
+		if (m_fifoInterruptEnabled) {
+			enableFifoInterrupt();
+		}
+	}
+
+	// The interrupt fires once the fill level reaches the watermark. At 200Hz gyro
+	// and 100Hz accel that is a 10ms pair of header frames, 13 + 7 bytes
+	static constexpr uint16_t FifoWatermarkBytes = 20;
+
+	bool m_fifoInterruptEnabled = false;
+
+	void enableFifoInterrupt() {
+		m_RegisterInterface.writeReg16(Regs::FifoWatermark, FifoWatermarkBytes);
+		m_RegisterInterface.writeReg(Regs::IntLatch::reg, Regs::IntLatch::value);
+		m_RegisterInterface.writeReg(Regs::Int1IoCtrl::reg, Regs::Int1IoCtrl::value);
+		m_RegisterInterface.writeReg(Regs::IntMapData::reg, Regs::IntMapData::value);
+		m_fifoInterruptEnabled = true;
 	}
 
 	bool initialize(MotionlessCalibrationData& gyroSensitivity) {
-		if (!restartAndInit()) {
-			return false;
+		delay(startInitialize(gyroSensitivity));
+		return finishInitialize();
+	}
+
+	// initialize() split at the power up wait, returns how long to wait before
+	// finishInitialize()
+	uint32_t startInitialize(MotionlessCalibrationData& gyroSensitivity) {
+		if (m_configUploadPending) {
+			m_configUploadPending = false;
+			if (!finishConfigUpload()) {
+				m_initFailed = true;
+				return 0;
+			}
 		}
 
-		setNormalConfig(gyroSensitivity);
+		m_initFailed = false;
+		return startNormalConfig(gyroSensitivity);
+	}
+
+	bool finishInitialize() {
+		if (m_initFailed) {
+			return false;
+		}
 
+		finishNormalConfig();
 		return true;
 	}
 
+	bool m_initFailed = false;
+
 	bool motionlessCalibration(MotionlessCalibrationData& gyroSensitivity) {
 		// perfrom gyroscope motionless sensitivity calibration (CRT)
 		// need to start from clean state according to spec
-		restartAndInit();
+		restartAndInit(true);
 		// only Accel ON
 		m_RegisterInterface.writeReg(Regs::PwrCtrl::reg, Regs::PwrCtrl::valueAccOn);
 		delay(100);
@@ -400,7 +606,7 @@ struct BMI270 {
 		// CRT seems to leave some state behind which isn't persisted after
 		// restart. If we continue without restarting, the gyroscope will behave
 		// differently on this run compared to subsequent restarts.
-		restartAndInit();
+		restartAndInit(true);
 
 		setNormalConfig(gyroSensitivity);
 
@@ -420,6 +626,9 @@ struct BMI270 {
 	using FifoBuffer = std::array<uint8_t, RegisterInterface::MaxTransactionLength>;
 	FifoBuffer read_buffer;
 
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+
 	template <typename T>
 	inline T getFromFifo(uint32_t& position, FifoBuffer& fifo) {
 		T to_ret;
@@ -428,8 +637,10 @@ struct BMI270 {
 		return to_ret;
 	}
 
-	void bulkRead(DriverCallbacks<int16_t>&& callbacks) {
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int16_t, Callbacks...>&& callbacks) {
 		const auto fifo_bytes = m_RegisterInterface.readReg16(Regs::FifoCount);
+		m_fifoHealth.recordFillLevel(fifo_bytes);
 
 		const auto bytes_to_read = std::min(
 			static_cast<size_t>(read_buffer.size()),
@@ -445,7 +656,12 @@ struct BMI270 {
 					// incomplete frame, nothing left to process
 					break;
 				}
-				getFromFifo<uint8_t>(i, read_buffer);  // skip 1 byte
+				// the payload is the amount of frames dropped due to an overrun
+				const auto skipped = getFromFifo<uint8_t>(i, read_buffer);
+				if (header == Fifo::SkipFrame) {
+					m_fifoHealth.overruns++;
+					m_fifoHealth.skippedFrames += skipped;
+				}
 			} else if ((header & Fifo::ModeMask) == Fifo::DataFrame) {
 				uint8_t gyro_data_length = header & Fifo::GyrDataBit ? 6 : 0;
 				uint8_t accel_data_length = header & Fifo::AccelDataBit ? 6 : 0;
@@ -480,6 +696,12 @@ struct BMI270 {
 					accel[2] = getFromFifo<uint16_t>(i, read_buffer);
 					callbacks.processAccelSample(accel, AccTs);
 				}
+			} else {
+				// no other frame types are enabled, we lost track of the frames
+				m_Logger.warn("Corrupted FIFO frame, flushing FIFO");
+				m_fifoHealth.recordCorruption(bytes_to_read - i);
+				m_RegisterInterface.writeReg(Regs::Cmd::reg, Regs::Cmd::valueFifoFlush);
+				return;
 			}
 		}
 	}
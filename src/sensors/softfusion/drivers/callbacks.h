@@ -24,11 +24,61 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
+#include <type_traits>
+#include <utility>
 
 template <typename SampleType>
+struct NoopSampleCallback {
+	void operator()(const SampleType sample[3], float Ts) const {}
+};
+
+struct NoopTempCallback {
+	void operator()(int16_t sample, float TempTs) const {}
+};
+
+// Aux magnetometer samples are always passed as 32 bit, raw from the mag's data
+// registers
+struct NoopMagCallback {
+	void operator()(const int32_t sample[3], float MagTs) const {}
+};
+
+// The callbacks are template parameters instead of std::function, so the
+// per-sample calls inside a driver's bulkRead are resolved at compile time and
+// can be inlined into the sensor's sample processing
+template <
+	typename SampleType,
+	typename AccelCallback = NoopSampleCallback<SampleType>,
+	typename GyroCallback = NoopSampleCallback<SampleType>,
+	typename TempCallback = NoopTempCallback,
+	typename MagCallback = NoopMagCallback>
 struct DriverCallbacks {
-	std::function<void(const SampleType sample[3], float AccTs)> processAccelSample;
-	std::function<void(const SampleType sample[3], float GyrTs)> processGyroSample;
-	std::function<void(int16_t sample, float TempTs)> processTempSample;
+	AccelCallback processAccelSample;
+	GyroCallback processGyroSample;
+	TempCallback processTempSample;
+	MagCallback processMagSample;
 };
+
+template <
+	typename SampleType,
+	typename AccelCallback,
+	typename GyroCallback,
+	typename TempCallback,
+	typename MagCallback = NoopMagCallback>
+auto makeDriverCallbacks(
+	AccelCallback&& processAccelSample,
+	GyroCallback&& processGyroSample,
+	TempCallback&& processTempSample,
+	MagCallback&& processMagSample = {}
+) {
+	return DriverCallbacks<
+		SampleType,
+		std::decay_t<AccelCallback>,
+		std::decay_t<GyroCallback>,
+		std::decay_t<TempCallback>,
+		std::decay_t<MagCallback>>{
+		std::forward<AccelCallback>(processAccelSample),
+		std::forward<GyroCallback>(processGyroSample),
+		std::forward<TempCallback>(processTempSample),
+		std::forward<MagCallback>(processMagSample),
+	};
+}
@@ -0,0 +1,101 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../../../sensorinterface/RegisterInterface.h"
+
+namespace SlimeVR::Sensors::SoftFusion::Drivers {
+
+// Reads the FIFO backlog into a single buffer as back-to-back transactions of the
+// largest size the register interface allows (whole entries only). A call starts at
+// most MaxTransactionsPerCall transactions, and stops early on blocking buses once
+// the time budget is spent. The rest stays in the FIFO for the next call, so a large
+// backlog neither stalls the loop nor grows the buffer past a few transactions.
+// Sensors whose frame size changes at runtime pass the current size, EntrySize is
+// the largest one. The reads are only started, so the bus can be busy while the
+// caller does something else.
+template <size_t EntrySize>
+struct ChunkedFifoReader {
+	static_assert(
+		RegisterInterface::MaxTransactionLength / EntrySize > 0,
+		"FIFO entry doesn't fit a transaction"
+	);
+
+	static constexpr size_t MaxTransactionsPerCall = 4;
+	static constexpr uint32_t ReadBudgetMicros = 2000;
+
+	// Allocate on heap so that it does not take up stack space, which can result in
+	// stack overflow and panic
+	std::vector<uint8_t> buffer;
+
+	void start(
+		const RegisterInterface& registerInterface,
+		uint8_t fifoDataReg,
+		size_t pendingEntries,
+		size_t entrySize = EntrySize
+	) {
+		// readBytes() takes the size as an uint8_t
+		const auto maxTransactionBytes = std::min(
+			registerInterface.getMaxTransactionLength(),
+			static_cast<size_t>(0xff)
+		);
+		const auto entriesPerTransaction = maxTransactionBytes / entrySize;
+		auto entriesLeft
+			= std::min(pendingEntries, entriesPerTransaction * MaxTransactionsPerCall);
+		if (buffer.size() < entriesLeft * entrySize) {
+			buffer.resize(entriesLeft * entrySize);
+		}
+
+		m_bytesStarted = 0;
+		const auto start = micros();
+		while (entriesLeft > 0) {
+			const auto entries = std::min(entriesLeft, entriesPerTransaction);
+			registerInterface.startReadBytes(
+				fifoDataReg,
+				entries * entrySize,
+				buffer.data() + m_bytesStarted
+			);
+			m_bytesStarted += entries * entrySize;
+			entriesLeft -= entries;
+
+			if (micros() - start >= ReadBudgetMicros) {
+				break;
+			}
+		}
+	}
+
+	// Returns the amount of bytes read into the buffer, which only holds them once the
+	// register interface finished its reads
+	size_t take() { return std::exchange(m_bytesStarted, 0); }
+
+private:
+	size_t m_bytesStarted = 0;
+};
+
+}  // namespace SlimeVR::Sensors::SoftFusion::Drivers
@@ -27,7 +27,9 @@
 #include <array>
 #include <cstdint>
 
+#include "../../FifoHealth.h"
 #include "callbacks.h"
+#include "fiforeader.h"
 #include "vqf.h"
 
 namespace SlimeVR::Sensors::SoftFusion::Drivers {
@@ -105,6 +107,34 @@ struct ICM42688 {
 				= 0b11 | (0b11 << 2);  // accel in low noise mode, gyro in low noise
 		};
 
+		struct IntConfig {
+			static constexpr uint8_t reg = 0x14;
+			static constexpr uint8_t value
+				= 0b1 | (0b1 << 1) | (0b1 << 2);  // INT1 active high, push-pull, latched
+		};
+		struct IntConfig0 {
+			static constexpr uint8_t reg = 0x63;
+			static constexpr uint8_t value
+				= (0b10 << 2);  // fifo threshold interrupt cleared on fifo read
+		};
+		struct IntConfig1 {
+			static constexpr uint8_t reg = 0x64;
+			static constexpr uint8_t value
+				= 0x00;  // INT_ASYNC_RESET=0, required for proper INT1 operation
+		};
+		struct IntSource0 {
+			static constexpr uint8_t reg = 0x65;
+			static constexpr uint8_t value = (0b1 << 2);  // fifo threshold on INT1
+		};
+		struct FifoConfig1Watermark {
+			static constexpr uint8_t reg = FifoConfig1::reg;
+			static constexpr uint8_t value
+				= FifoConfig1::value
+				| (0b1 << 5);  // keep firing while fifo is above watermark
+		};
+
+		static constexpr uint8_t FifoWatermark = 0x60;  // 12 bits, in bytes
+
 		// TODO: might be worth checking
 		// GYRO_CONFIG1
 		// GYRO_ACCEL_CONFIG0
@@ -112,6 +142,11 @@ struct ICM42688 {
 
 		static constexpr uint8_t FifoCount = 0x2e;
 		static constexpr uint8_t FifoData = 0x30;
+
+		struct SignalPathReset {
+			static constexpr uint8_t reg = 0x4b;
+			static constexpr uint8_t valueFifoFlush = (0b1 << 1);
+		};
 	};
 
 #pragma pack(push, 1)
@@ -133,14 +168,35 @@ struct ICM42688 {
 
 	static constexpr size_t FullFifoEntrySize = sizeof(FifoEntryAligned) + 1;
 
-	bool initialize() {
-		// perform initialization step
+	// Two packets, 10ms at 200Hz gyro ODR
+	static constexpr uint16_t FifoWatermarkBytes = FullFifoEntrySize * 2;
+
+	ChunkedFifoReader<FullFifoEntrySize> fifoReader;
+
+	static constexpr size_t FifoCapacityBytes = 2048;
+
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+	bool m_fifoResetPending = false;
+
+	void resetFifo() {
+		m_RegisterInterface.writeReg(
+			Regs::SignalPathReset::reg,
+			Regs::SignalPathReset::valueFifoFlush
+		);
+	}
+
+	// Returns how long to wait before initialize()
+	uint32_t startReset() {
 		m_RegisterInterface.writeReg(
 			Regs::DeviceConfig::reg,
 			Regs::DeviceConfig::valueSwReset
 		);
-		delay(20);
+		return 20;
+	}
 
+	bool initialize() {
+		// perform initialization step
 		m_RegisterInterface.writeReg(Regs::IntfConfig0::reg, Regs::IntfConfig0::value);
 		m_RegisterInterface.writeReg(Regs::GyroConfig::reg, Regs::GyroConfig::value);
 		m_RegisterInterface.writeReg(Regs::AccelConfig::reg, Regs::AccelConfig::value);
@@ -152,18 +208,54 @@ struct ICM42688 {
 		return true;
 	}
 
-	void bulkRead(DriverCallbacks<int32_t>&& callbacks) {
+	void enableFifoInterrupt() {
+		m_RegisterInterface.writeReg(Regs::IntConfig::reg, Regs::IntConfig::value);
+		m_RegisterInterface.writeReg(Regs::IntConfig0::reg, Regs::IntConfig0::value);
+		m_RegisterInterface.writeReg(Regs::IntConfig1::reg, Regs::IntConfig1::value);
+		m_RegisterInterface.writeReg16(Regs::FifoWatermark, FifoWatermarkBytes);
+		m_RegisterInterface.writeReg(
+			Regs::FifoConfig1Watermark::reg,
+			Regs::FifoConfig1Watermark::value
+		);
+		m_RegisterInterface.writeReg(Regs::IntSource0::reg, Regs::IntSource0::value);
+	}
+
+	// Reads the FIFO level and starts reading its contents. Once the register
+	// interface finished the reads, bulkRead() parses them without touching the bus
+	void startBulkRead() {
+		if (m_fifoResetPending) {
+			m_fifoResetPending = false;
+			resetFifo();
+			return;
+		}
+
 		const auto fifo_bytes = m_RegisterInterface.readReg16(Regs::FifoCount);
+		m_fifoHealth.recordFillLevel(fifo_bytes);
+		if (fifo_bytes >= FifoCapacityBytes) {
+			m_fifoHealth.overruns++;
+		}
+
+		fifoReader.start(
+			m_RegisterInterface,
+			Regs::FifoData,
+			fifo_bytes / FullFifoEntrySize
+		);
+	}
 
-		std::array<uint8_t, FullFifoEntrySize * 8> read_buffer;  // max 8 readings
-		const auto bytes_to_read = std::min(
-									   static_cast<size_t>(read_buffer.size()),
-									   static_cast<size_t>(fifo_bytes)
-								   )
-								 / FullFifoEntrySize * FullFifoEntrySize;
-		m_RegisterInterface
-			.readBytes(Regs::FifoData, bytes_to_read, read_buffer.data());
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int32_t, Callbacks...>&& callbacks) {
+		const auto bytes_to_read = fifoReader.take();
+		const auto& read_buffer = fifoReader.buffer;
 		for (auto i = 0u; i < bytes_to_read; i += FullFifoEntrySize) {
+			const uint8_t header = read_buffer[i];
+			if (header & (1 << 7)) {
+				// header says the fifo is empty, so we're out of sync with the frames
+				m_Logger.warn("Corrupted FIFO frame, resetting FIFO");
+				m_fifoHealth.recordCorruption(bytes_to_read - i);
+				m_fifoResetPending = true;
+				return;
+			}
+
 			FifoEntryAligned entry;
 			memcpy(
 				entry.raw,
@@ -171,12 +263,19 @@ struct ICM42688 {
 				sizeof(FifoEntryAligned)
 			);  // skip fifo header
 
-			const int32_t gyroData[3]{
-				static_cast<int32_t>(entry.part.gyro[0]) << 4 | (entry.part.xlsb & 0xf),
-				static_cast<int32_t>(entry.part.gyro[1]) << 4 | (entry.part.ylsb & 0xf),
-				static_cast<int32_t>(entry.part.gyro[2]) << 4 | (entry.part.zlsb & 0xf),
-			};
-			callbacks.processGyroSample(gyroData, GyrTs);
+			if (entry.part.gyro[0] != -32768) {
+				const int32_t gyroData[3]{
+					static_cast<int32_t>(entry.part.gyro[0]) << 4
+						| (entry.part.xlsb & 0xf),
+					static_cast<int32_t>(entry.part.gyro[1]) << 4
+						| (entry.part.ylsb & 0xf),
+					static_cast<int32_t>(entry.part.gyro[2]) << 4
+						| (entry.part.zlsb & 0xf),
+				};
+				callbacks.processGyroSample(gyroData, GyrTs);
+			} else {
+				m_fifoHealth.invalidFrames++;
+			}
 
 			if (entry.part.accel[0] != -32768) {
 				const int32_t accelData[3]{
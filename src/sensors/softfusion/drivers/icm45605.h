@@ -52,7 +52,6 @@ struct ICM45605 : public ICM45Base {
 	};
 
 	bool initialize() {
-		ICM45Base::softResetIMU();
 		return ICM45Base::initializeBase();
 	}
 };
@@ -22,10 +22,13 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
 #include "../../../sensorinterface/RegisterInterface.h"
+#include "../../FifoHealth.h"
 #include "callbacks.h"
+#include "fiforeader.h"
 #include "sensors/softfusion/magdriver.h"
 
 namespace SlimeVR::Sensors::SoftFusion::Drivers {
@@ -86,6 +89,15 @@ struct ICM45Base {
 				= (0b01 << 6) | (0b011111);  // stream to FIFO mode, FIFO depth
 											 // 8k bytes <-- this disables all APEX
 											 // features, but we don't need them
+			static constexpr uint8_t valueBypass = (0b00 << 6) | (0b011111);
+		};
+
+		struct FifoConfig4 {
+			static constexpr uint8_t reg = 0x22;
+			static constexpr uint8_t valueNoAux = 0;
+			static constexpr uint8_t valueAux6Byte = (0b1 << 1);  // ES0 to FIFO
+			static constexpr uint8_t valueAux9Byte
+				= (0b1 << 1) | (0b1 << 0);  // ES0 to FIFO, 9 bytes wide
 		};
 
 		struct FifoConfig3 {
@@ -106,6 +118,21 @@ struct ICM45Base {
 		static constexpr uint8_t FifoCount = 0x12;
 		static constexpr uint8_t FifoData = 0x14;
 
+		struct Int1Config0 {
+			static constexpr uint8_t reg = 0x16;
+			static constexpr uint8_t value = (0b1 << 1);  // fifo threshold on INT1
+		};
+
+		struct Int1Config2 {
+			static constexpr uint8_t reg = 0x18;
+			static constexpr uint8_t value
+				= (0b0 << 2) | (0b1 << 1) | (0b1 << 0);  // push-pull, latched, high
+		};
+
+		static constexpr uint8_t Int1Status0 = 0x19;  // cleared on read
+
+		static constexpr uint8_t FifoWatermark = 0x1e;  // 16 bits, in frames
+
 		// Indirect Register Access
 
 		static constexpr uint32_t IRegWaitTimeMicros = 4;
@@ -157,7 +184,11 @@ struct ICM45Base {
 		};
 
 		struct DmpExtSenOdrCfg {
-			// TODO: todo
+			static constexpr Bank bank = Bank::IPregTop1;
+			static constexpr uint8_t reg = 0x27;
+			static constexpr uint8_t valueDisabled = 0;
+			static constexpr uint8_t valueEnabled
+				= (0b1 << 6) | (0b011 << 3);  // poll external sensor, odr=100Hz
 		};
 
 		struct I2CMControl {
@@ -189,13 +220,25 @@ struct ICM45Base {
 #pragma pack(pop)
 
 	static constexpr size_t FullFifoEntrySize = sizeof(FifoEntryAligned) + 1;
+	// Aux polling adds an extended header byte and up to 9 bytes of ES0 data,
+	// which sit between the gyro and the temperature in the frame
+	static constexpr size_t MaxAuxDataSize = 9;
+	static constexpr size_t MaxFifoEntrySize = FullFifoEntrySize + 1 + MaxAuxDataSize;
+	static constexpr size_t AccelGyroSize = offsetof(FifoEntryAligned, temp);
+
+	// Two frames (~10ms at 204.8Hz gyro ODR), plus one as only M-1 frames are read
+	// (see AN-000364 below)
+	static constexpr uint16_t FifoWatermarkFrames = 3;
+
+	bool m_fifoInterruptEnabled = false;
 
-	void softResetIMU() {
+	// Returns how long to wait before initialize()
+	uint32_t startReset() {
 		m_RegisterInterface.writeReg(
 			BaseRegs::DeviceConfig::reg,
 			BaseRegs::DeviceConfig::valueSwReset
 		);
-		delay(35);
+		return 35;
 	}
 
 	bool initializeBase() {
@@ -226,27 +269,90 @@ struct ICM45Base {
 			BaseRegs::IOCPadScenarioAuxOvrd::value
 		);
 
-		read_buffer.resize(FullFifoEntrySize * MaxReadings);
-
 		delay(1);
 
 		return true;
 	}
 
-	static constexpr size_t MaxReadings = 8;
-	// Allocate on heap so that it does not take up stack space, which can result in
-	// stack overflow and panic
-	std::vector<uint8_t> read_buffer;
+	void enableFifoInterrupt() {
+		m_RegisterInterface.writeReg16(BaseRegs::FifoWatermark, FifoWatermarkFrames);
+		m_RegisterInterface.writeReg(
+			BaseRegs::Int1Config2::reg,
+			BaseRegs::Int1Config2::value
+		);
+		m_RegisterInterface.writeReg(
+			BaseRegs::Int1Config0::reg,
+			BaseRegs::Int1Config0::value
+		);
+		m_fifoInterruptEnabled = true;
+	}
 
-	void bulkRead(DriverCallbacks<int32_t>&& callbacks) {
-		constexpr int16_t InvalidReading = -32768;
+	ChunkedFifoReader<MaxFifoEntrySize> fifoReader;
 
-		size_t fifo_packets = m_RegisterInterface.readReg16(BaseRegs::FifoCount);
+	static constexpr size_t FifoCapacityBytes = 8192;
+
+	bool m_auxPolling = false;
+	size_t m_auxDataSize = 0;
+
+	size_t fifoEntrySize() const {
+		if (!m_auxPolling) {
+			return FullFifoEntrySize;
+		}
+		return FullFifoEntrySize + 1 + m_auxDataSize;
+	}
+
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+	bool m_fifoResetPending = false;
+
+	void resetFifo() {
+		// bypass mode flushes the fifo and clears a corrupted fifo state
+		m_RegisterInterface.writeReg(
+			BaseRegs::FifoConfig0::reg,
+			BaseRegs::FifoConfig0::valueBypass
+		);
+		m_RegisterInterface.writeReg(
+			BaseRegs::FifoConfig0::reg,
+			BaseRegs::FifoConfig0::value
+		);
+	}
+
+	// Frames already in the fifo keep their old layout, so flush it while changing
+	// what goes into it
+	void setFifoAuxConfig(uint8_t fifoConfig4) {
+		m_RegisterInterface.writeReg(
+			BaseRegs::FifoConfig0::reg,
+			BaseRegs::FifoConfig0::valueBypass
+		);
+		m_RegisterInterface.writeReg(BaseRegs::FifoConfig4::reg, fifoConfig4);
+		m_RegisterInterface.writeReg(
+			BaseRegs::FifoConfig0::reg,
+			BaseRegs::FifoConfig0::value
+		);
+	}
 
-		if (fifo_packets <= 1) {
+	// Reads the FIFO level and starts reading its contents. Once the register
+	// interface finished the reads, bulkRead() parses them without touching the bus
+	void startBulkRead() {
+		if (m_fifoResetPending) {
+			m_fifoResetPending = false;
+			resetFifo();
 			return;
 		}
 
+		if (m_fifoInterruptEnabled) {
+			// release the latched watermark interrupt
+			[[maybe_unused]] const auto status
+				= m_RegisterInterface.readReg(BaseRegs::Int1Status0);
+		}
+
+		const size_t entrySize = fifoEntrySize();
+		size_t fifo_packets = m_RegisterInterface.readReg16(BaseRegs::FifoCount);
+		m_fifoHealth.recordFillLevel(fifo_packets * entrySize);
+		if (fifo_packets >= FifoCapacityBytes / entrySize) {
+			m_fifoHealth.overruns++;
+		}
+
 		// AN-000364
 		// 2.16 FIFO EMPTY EVENT IN STREAMING MODE CAN CORRUPT FIFO DATA
 		//
@@ -262,25 +368,66 @@ struct ICM45Base {
 		// in the FIFO buffer, the host should only read the first M-1
 		// number of FIFO frames. This prevents the FIFO empty event, that
 		// can cause FIFO data corruption, from happening.
-		--fifo_packets;
+		fifoReader.start(
+			m_RegisterInterface,
+			BaseRegs::FifoData,
+			fifo_packets > 0 ? fifo_packets - 1 : 0,
+			entrySize
+		);
+	}
 
-		fifo_packets = std::min(fifo_packets, MaxReadings);
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int32_t, Callbacks...>&& callbacks) {
+		constexpr int16_t InvalidReading = -32768;
 
-		size_t bytes_to_read = fifo_packets * FullFifoEntrySize;
-		m_RegisterInterface
-			.readBytes(BaseRegs::FifoData, bytes_to_read, read_buffer.data());
+		const size_t entrySize = fifoEntrySize();
+		const auto bytes_to_read = fifoReader.take();
+		const auto& read_buffer = fifoReader.buffer;
 
-		for (auto i = 0u; i < bytes_to_read; i += FullFifoEntrySize) {
+		for (auto i = 0u; i < bytes_to_read; i += entrySize) {
 			uint8_t header = read_buffer[i];
+			bool has_extended_header = header & (1 << 7);
 			bool has_gyro = header & (1 << 5);
 			bool has_accel = header & (1 << 6);
 
+			// extended headers only come with aux polling and we always run in hires
+			// mode, any other header means we lost track of the frames (see
+			// AN-000364 above)
+			if (has_extended_header != m_auxPolling || !(header & (1 << 4))) {
+				m_Logger.warn("Corrupted FIFO frame, resetting FIFO");
+				m_fifoHealth.recordCorruption(bytes_to_read - i);
+				m_fifoResetPending = true;
+				return;
+			}
+
+			// skip fifo header (and extended header)
+			size_t offset = i + (m_auxPolling ? 2 : 1);
+
 			FifoEntryAligned entry;
+			memcpy(&entry, &read_buffer[offset], AccelGyroSize);
+			offset += AccelGyroSize;
+			if (m_auxPolling) {
+				// the ES0 slot is in every frame, but only holds a new mag reading
+				// when the I2C master finished a read since the last frame
+				const uint8_t extended_header = read_buffer[i + 1];
+				if (extended_header & (1 << 2)) {
+					int32_t magData[3];
+					decodeAuxSample(&read_buffer[offset], magData);
+					callbacks.processMagSample(magData, MagTs);
+				}
+				offset += m_auxDataSize;
+			}
 			memcpy(
-				&entry,
-				&read_buffer[i + 0x1],
-				sizeof(FifoEntryAligned)
-			);  // skip fifo header
+				&entry.temp,
+				&read_buffer[offset],
+				sizeof(FifoEntryAligned) - AccelGyroSize
+			);
+
+			// gyro runs at the highest ODR so it should be in every frame, invalid
+			// accel values are expected though, as accel runs at half the rate
+			if (has_gyro && entry.gyro[0] == InvalidReading) {
+				m_fifoHealth.invalidFrames++;
+			}
 
 			if (has_gyro && entry.gyro[0] != InvalidReading) {
 				const int32_t gyroData[3]{
@@ -309,6 +456,25 @@ struct ICM45Base {
 		}
 	}
 
+	// Mags store their axes little endian, 16 or 24 bits wide
+	void decodeAuxSample(const uint8_t* data, int32_t magData[3]) const {
+		if (m_auxDataSize == 6) {
+			for (size_t axis = 0; axis < 3; axis++) {
+				magData[axis] = static_cast<int16_t>(
+					data[axis * 2] | (data[axis * 2 + 1] << 8)
+				);
+			}
+			return;
+		}
+
+		for (size_t axis = 0; axis < 3; axis++) {
+			const uint32_t value = data[axis * 3] | (data[axis * 3 + 1] << 8)
+								 | (data[axis * 3 + 2] << 16);
+			// sign extend from 24 bits
+			magData[axis] = static_cast<int32_t>(value << 8) >> 8;
+		}
+	}
+
 	template <typename Reg>
 	uint8_t readBankRegister() {
 		uint8_t buffer;
@@ -364,25 +530,38 @@ struct ICM45Base {
 		writeBankRegister<typename BaseRegs::I2CMDevProfile1>(deviceId);
 	}
 
-	uint8_t readAux(uint8_t address) {
-		writeBankRegister<typename BaseRegs::I2CMDevProfile0>(address);
+	static constexpr uint32_t AuxTransactionTimeoutMicros = 5000;
 
-		writeBankRegister<typename BaseRegs::I2CMCommand0>(
-			(0b1 << 7)  // Last transaction
-			| (0b0 << 6)  // Channel 0
-			| (0b01 << 4)  // Read with register
-			| (0b0001 << 0)  // Read 1 byte
-		);
+	uint8_t runAuxTransaction(uint8_t command) {
+		writeBankRegister<typename BaseRegs::I2CMCommand0>(command);
 		writeBankRegister<typename BaseRegs::I2CMControl>(
 			(0b0 << 6)  // No restarts
 			| (0b0 << 3)  // Fast mode
 			| (0b1 << 0)  // Start transaction
 		);
 
+		// a missing or stuck aux device must not hang the main loop
+		const auto start = micros();
 		uint8_t lastStatus;
 		while ((lastStatus = readBankRegister<typename BaseRegs::I2CMStatus>())
-			   & BaseRegs::I2CMStatus::Busy)
-			;
+			   & BaseRegs::I2CMStatus::Busy) {
+			if (micros() - start >= AuxTransactionTimeoutMicros) {
+				break;
+			}
+		}
+
+		return lastStatus;
+	}
+
+	uint8_t readAux(uint8_t address) {
+		writeBankRegister<typename BaseRegs::I2CMDevProfile0>(address);
+
+		const uint8_t lastStatus = runAuxTransaction(
+			(0b1 << 7)  // Last transaction
+			| (0b0 << 6)  // Channel 0
+			| (0b01 << 4)  // Read with register
+			| (0b0001 << 0)  // Read 1 byte
+		);
 
 		if (lastStatus != BaseRegs::I2CMStatus::Done) {
 			m_Logger.error(
@@ -398,23 +577,14 @@ struct ICM45Base {
 	void writeAux(uint8_t address, uint8_t value) {
 		writeBankRegister<typename BaseRegs::I2CMDevProfile0>(address);
 		writeBankRegister<typename BaseRegs::I2CMWrData0>(value);
-		writeBankRegister<typename BaseRegs::I2CMCommand0>(
+
+		const uint8_t lastStatus = runAuxTransaction(
 			(0b1 << 7)  // Last transaction
 			| (0b0 << 6)  // Channel 0
-			| (0b01 << 4)  // Read with register
-			| (0b0001 << 0)  // Read 1 byte
-		);
-		writeBankRegister<typename BaseRegs::I2CMControl>(
-			(0b0 << 6)  // No restarts
-			| (0b0 << 3)  // Fast mode
-			| (0b1 << 0)  // Start transaction
+			| (0b10 << 4)  // Write
+			| (0b0001 << 0)  // Write 1 byte
 		);
 
-		uint8_t lastStatus;
-		while ((lastStatus = readBankRegister<typename BaseRegs::I2CMStatus>())
-			   & BaseRegs::I2CMStatus::Busy)
-			;
-
 		if (lastStatus != BaseRegs::I2CMStatus::Done) {
 			m_Logger.error(
 				"Aux write to address 0x%02x with value 0x%02x returned status 0x%02x",
@@ -425,12 +595,37 @@ struct ICM45Base {
 		}
 	}
 
+	// The I2C master reads the data registers of the aux device on its own at the
+	// external sensor ODR and stores them as ES0 data in the FIFO frames
 	void startAuxPolling(uint8_t dataReg, MagDataWidth dataWidth) {
-		// TODO:
+		const bool nineByte = dataWidth == MagDataWidth::NineByte;
+		m_auxDataSize = nineByte ? 9 : 6;
+
+		writeBankRegister<typename BaseRegs::I2CMDevProfile0>(dataReg);
+		writeBankRegister<typename BaseRegs::I2CMCommand0>(
+			(0b1 << 7)  // Last transaction
+			| (0b0 << 6)  // Channel 0
+			| (0b01 << 4)  // Read with register
+			| (static_cast<uint8_t>(m_auxDataSize) << 0)  // Read the whole sample
+		);
+		writeBankRegister<typename BaseRegs::DmpExtSenOdrCfg>(
+			BaseRegs::DmpExtSenOdrCfg::valueEnabled
+		);
+
+		setFifoAuxConfig(
+			nineByte ? BaseRegs::FifoConfig4::valueAux9Byte
+					 : BaseRegs::FifoConfig4::valueAux6Byte
+		);
+		m_auxPolling = true;
 	}
 
 	void stopAuxPolling() {
-		// TODO:
+		writeBankRegister<typename BaseRegs::DmpExtSenOdrCfg>(
+			BaseRegs::DmpExtSenOdrCfg::valueDisabled
+		);
+
+		setFifoAuxConfig(BaseRegs::FifoConfig4::valueNoAux);
+		m_auxPolling = false;
 	}
 };
 
@@ -28,7 +28,10 @@
 #include <cstdint>
 
 #include "../../../sensorinterface/RegisterInterface.h"
+#include "../../FifoHealth.h"
 #include "callbacks.h"
+#include "fiforeader.h"
+#include "timestamps.h"
 
 namespace SlimeVR::Sensors::SoftFusion::Drivers {
 
@@ -54,34 +57,99 @@ struct LSM6DSOutputHandler {
 
 	static constexpr size_t FullFifoEntrySize = sizeof(FifoEntryAligned) + 1;
 
+	// Every 10ms the FIFO gets about 2 gyro, 1 accel, 2 timestamp and 0.5 temperature
+	// words at 208Hz gyro ODR, so this fires after ~10ms (~9ms at 240Hz)
+	static constexpr uint8_t FifoWatermarkWords = 6;
+
+	ChunkedFifoReader<FullFifoEntrySize> fifoReader;
+
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+	bool m_fifoResetPending = false;
+
 	template <typename Regs>
-	void bulkRead(
-		DriverCallbacks<int16_t>&& callbacks,
-		float GyrTs,
-		float AccTs,
-		float TempTs
-	) {
+	void resetFifo() {
+		// cycling through bypass mode empties the fifo
+		m_RegisterInterface.writeReg(
+			Regs::FifoCtrl4Mode::reg,
+			Regs::FifoCtrl4Mode::value & ~0b111
+		);
+		m_RegisterInterface.writeReg(
+			Regs::FifoCtrl4Mode::reg,
+			Regs::FifoCtrl4Mode::value
+		);
+		m_hasFifoTimestamp = false;
+		m_gyroTimestamps.invalidate();
+		m_accelTimestamps.invalidate();
+	}
+
+	template <typename Regs>
+	void enableFifoInterrupt() {
+		// the fifo threshold signal is level based, it stays high for as long as the
+		// fifo holds at least the watermark amount of words
+		m_RegisterInterface.writeReg(Regs::FifoCtrl1WTM, FifoWatermarkWords);
+		m_RegisterInterface.writeReg(Regs::Int1Ctrl::reg, Regs::Int1Ctrl::value);
+	}
+
+	// Timestamp of the current batch, a timestamp word is written for every batch of
+	// samples (DEC_TS_BATCH = 1)
+	uint32_t m_fifoTimestamp = 0;
+	bool m_hasFifoTimestamp = false;
+	SampleTimestamps<> m_gyroTimestamps;
+	SampleTimestamps<> m_accelTimestamps;
+
+	template <typename Regs>
+	void enableTimestamps() {
+		m_RegisterInterface.writeReg(Regs::TimestampEn::reg, Regs::TimestampEn::value);
+	}
+
+	float sampleTs(SampleTimestamps<>& timestamps, float TimestampTs, float nominalTs) {
+		if (!m_hasFifoTimestamp) {
+			return nominalTs;
+		}
+		return timestamps.update(m_fifoTimestamp, TimestampTs, nominalTs);
+	}
+
+	// Reads the FIFO level and starts reading its contents. Once the register
+	// interface finished the reads, bulkRead() parses them without touching the bus
+	template <typename Regs>
+	void startBulkRead() {
+		if (m_fifoResetPending) {
+			m_fifoResetPending = false;
+			resetFifo<Regs>();
+			return;
+		}
+
 		constexpr auto FIFO_SAMPLES_MASK = 0x3ff;
 		constexpr auto FIFO_OVERRUN_LATCHED_MASK = 0x800;
 
 		const auto fifo_status = m_RegisterInterface.readReg16(Regs::FifoStatus);
 		const auto available_axes = fifo_status & FIFO_SAMPLES_MASK;
-		const auto fifo_bytes = available_axes * FullFifoEntrySize;
+		m_fifoHealth.recordFillLevel(available_axes * FullFifoEntrySize);
 		if (fifo_status & FIFO_OVERRUN_LATCHED_MASK) {
+			m_fifoHealth.overruns++;
 			// FIFO overrun is expected to happen during startup and calibration
 			m_Logger.error(
 				"FIFO OVERRUN! This occuring during normal usage is an issue."
 			);
+			m_hasFifoTimestamp = false;
+			m_gyroTimestamps.invalidate();
+			m_accelTimestamps.invalidate();
 		}
 
-		std::array<uint8_t, FullFifoEntrySize * 8> read_buffer;  // max 8 readings
-		const auto bytes_to_read = std::min(
-									   static_cast<size_t>(read_buffer.size()),
-									   static_cast<size_t>(fifo_bytes)
-								   )
-								 / FullFifoEntrySize * FullFifoEntrySize;
-		m_RegisterInterface
-			.readBytes(Regs::FifoData, bytes_to_read, read_buffer.data());
+		fifoReader.start(m_RegisterInterface, Regs::FifoData, available_axes);
+	}
+
+	template <typename Regs, typename... Callbacks>
+	void bulkRead(
+		DriverCallbacks<int16_t, Callbacks...>&& callbacks,
+		float GyrTs,
+		float AccTs,
+		float TempTs,
+		float TimestampTs
+	) {
+		const auto bytes_to_read = fifoReader.take();
+		const auto& read_buffer = fifoReader.buffer;
 		for (auto i = 0u; i < bytes_to_read; i += FullFifoEntrySize) {
 			FifoEntryAligned entry;
 			uint8_t tag = read_buffer[i] >> 3;
@@ -93,14 +161,30 @@ struct LSM6DSOutputHandler {
 
 			switch (tag) {
 				case 0x01:  // Gyro NC
-					callbacks.processGyroSample(entry.xyz, GyrTs);
+					callbacks.processGyroSample(
+						entry.xyz,
+						sampleTs(m_gyroTimestamps, TimestampTs, GyrTs)
+					);
 					break;
 				case 0x02:  // Accel NC
-					callbacks.processAccelSample(entry.xyz, AccTs);
+					callbacks.processAccelSample(
+						entry.xyz,
+						sampleTs(m_accelTimestamps, TimestampTs, AccTs)
+					);
 					break;
 				case 0x03:  // Temperature
 					callbacks.processTempSample(entry.xyz[0], TempTs);
 					break;
+				case 0x04:  // Timestamp
+					memcpy(&m_fifoTimestamp, entry.raw, sizeof(m_fifoTimestamp));
+					m_hasFifoTimestamp = true;
+					break;
+				default:
+					// nothing else is batched, so we're reading garbage
+					m_Logger.warn("Unexpected FIFO tag %d, resetting FIFO", tag);
+					m_fifoHealth.recordCorruption(bytes_to_read - i);
+					m_fifoResetPending = true;
+					return;
 			}
 		}
 	}
@@ -28,6 +28,7 @@
 #include <cstdint>
 
 #include "../../../sensorinterface/RegisterInterface.h"
+#include "../../FifoHealth.h"
 #include "callbacks.h"
 #include "vqf.h"
 
@@ -107,12 +108,25 @@ struct LSM6DS3TRC {
 
 		static constexpr uint8_t FifoStatus = 0x3a;
 		static constexpr uint8_t FifoData = 0x3e;
+
+		static constexpr uint8_t FifoCtrl1FTH = 0x06;
+		struct Int1Ctrl {
+			static constexpr uint8_t reg = 0x0d;
+			static constexpr uint8_t value = (1 << 3);  // fifo threshold on INT1
+		};
 	};
 
+	// Two 6 word gyro + accel patterns, ~10ms at 208Hz gyro ODR
+	static constexpr uint16_t FifoWatermarkWords = 12;
+
+	// Returns how long to wait before initialize()
+	uint32_t startReset() {
+		m_RegisterInterface.writeReg(Regs::Ctrl3C::reg, Regs::Ctrl3C::valueSwReset);
+		return 20;
+	}
+
 	bool initialize() {
 		// perform initialization step
-		m_RegisterInterface.writeReg(Regs::Ctrl3C::reg, Regs::Ctrl3C::valueSwReset);
-		delay(20);
 		m_RegisterInterface.writeReg(Regs::Ctrl1XL::reg, Regs::Ctrl1XL::value);
 		m_RegisterInterface.writeReg(Regs::Ctrl2G::reg, Regs::Ctrl2G::value);
 		m_RegisterInterface.writeReg(Regs::Ctrl3C::reg, Regs::Ctrl3C::value);
@@ -122,11 +136,29 @@ struct LSM6DS3TRC {
 		return true;
 	}
 
-	void bulkRead(DriverCallbacks<int16_t>&& callbacks) {
+	void enableFifoInterrupt() {
+		// threshold bits 10:8 share FIFO_CTRL2 with the temperature enable bit
+		m_RegisterInterface.writeReg(Regs::FifoCtrl1FTH, FifoWatermarkWords & 0xff);
+		m_RegisterInterface.writeReg(
+			Regs::FifoCtrl2::reg,
+			Regs::FifoCtrl2::value | ((FifoWatermarkWords >> 8) & 0b111)
+		);
+		m_RegisterInterface.writeReg(Regs::Int1Ctrl::reg, Regs::Int1Ctrl::value);
+	}
+
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int16_t, Callbacks...>&& callbacks) {
 		const auto read_result = m_RegisterInterface.readReg16(Regs::FifoStatus);
+		m_fifoHealth.recordFillLevel((read_result & 0x7ff) * sizeof(uint16_t));
 		if (read_result & 0x4000) {  // overrun!
 			// disable and re-enable fifo to clear it
 			m_Logger.debug("Fifo overrun, resetting...");
+			m_fifoHealth.overruns++;
+			m_fifoHealth.recoveries++;
+			m_fifoHealth.discardedBytes += (read_result & 0x7ff) * sizeof(uint16_t);
 			m_RegisterInterface.writeReg(Regs::FifoCtrl5::reg, 0);
 			m_RegisterInterface.writeReg(Regs::FifoCtrl5::reg, Regs::FifoCtrl5::value);
 			return;
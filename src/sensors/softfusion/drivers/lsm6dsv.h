@@ -51,6 +51,9 @@ struct LSM6DSV : LSM6DSOutputHandler {
 	static constexpr float MagTs = 1.0 / MagFreq;
 	static constexpr float TempTs = 1.0 / TempFreq;
 
+	static constexpr bool HasFifoTimestamps = true;
+	static constexpr float TimestampTs = 21.75e-6f;
+
 	static constexpr float GyroSensitivity = 1000 / 35.0f;
 	static constexpr float AccelSensitivity = 1000 / 0.244f;
 
@@ -99,21 +102,37 @@ struct LSM6DSV : LSM6DSOutputHandler {
 		};
 		struct FifoCtrl4Mode {
 			static constexpr uint8_t reg = 0x0a;
-			static constexpr uint8_t value = (0b110110);  // continuous mode,
-														  // temperature at 60Hz
+			static constexpr uint8_t value
+				= (0b01 << 6) | (0b110110);  // timestamp every batch, continuous mode,
+											 // temperature at 60Hz
+		};
+
+		struct TimestampEn {
+			static constexpr uint8_t reg = 0x50;
+			static constexpr uint8_t value = (1 << 6);  // TIMESTAMP_EN = 1
 		};
 
 		static constexpr uint8_t FifoStatus = 0x1b;
 		static constexpr uint8_t FifoData = 0x78;
+
+		static constexpr uint8_t FifoCtrl1WTM = 0x07;
+		struct Int1Ctrl {
+			static constexpr uint8_t reg = 0x0d;
+			static constexpr uint8_t value = (1 << 3);  // fifo threshold on INT1
+		};
 	};
 
 	LSM6DSV(RegisterInterface& registerInterface, SlimeVR::Logging::Logger& logger)
 		: LSM6DSOutputHandler(registerInterface, logger) {}
 
+	// Returns how long to wait before initialize()
+	uint32_t startReset() {
+		m_RegisterInterface.writeReg(Regs::Ctrl3C::reg, Regs::Ctrl3C::valueSwReset);
+		return 20;
+	}
+
 	bool initialize() {
 		// perform initialization step
-		m_RegisterInterface.writeReg(Regs::Ctrl3C::reg, Regs::Ctrl3C::valueSwReset);
-		delay(20);
 		m_RegisterInterface.writeReg(Regs::HAODRCFG::reg, Regs::HAODRCFG::value);
 		m_RegisterInterface.writeReg(Regs::Ctrl1XLODR::reg, Regs::Ctrl1XLODR::value);
 		m_RegisterInterface.writeReg(Regs::Ctrl2GODR::reg, Regs::Ctrl2GODR::value);
@@ -128,15 +147,24 @@ struct LSM6DSV : LSM6DSOutputHandler {
 			Regs::FifoCtrl4Mode::reg,
 			Regs::FifoCtrl4Mode::value
 		);
+		LSM6DSOutputHandler::template enableTimestamps<Regs>();
 		return true;
 	}
 
-	void bulkRead(DriverCallbacks<int16_t>&& callbacks) {
+	void enableFifoInterrupt() {
+		LSM6DSOutputHandler::template enableFifoInterrupt<Regs>();
+	}
+
+	void startBulkRead() { LSM6DSOutputHandler::template startBulkRead<Regs>(); }
+
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int16_t, Callbacks...>&& callbacks) {
 		LSM6DSOutputHandler::template bulkRead<Regs>(
 			std::move(callbacks),
 			GyrTs,
 			AccTs,
-			TempTs
+			TempTs,
+			TimestampTs
 		);
 	}
 };
@@ -30,6 +30,7 @@
 #include <cstdint>
 
 #include "../../../sensorinterface/RegisterInterface.h"
+#include "../../FifoHealth.h"
 #include "callbacks.h"
 #include "vqf.h"
 
@@ -121,13 +122,16 @@ struct MPU6050 {
 		);
 	}
 
-	bool initialize() {
-		// Reset
+	// Returns how long to wait before initialize()
+	uint32_t startReset() {
 		m_RegisterInterface.writeReg(
 			MPU6050_RA_PWR_MGMT_1,
 			0x80
 		);  // PWR_MGMT_1: reset with 100ms delay (also disables sleep)
-		delay(100);
+		return 100;
+	}
+
+	bool initialize() {
 		m_RegisterInterface.writeReg(
 			MPU6050_RA_SIGNAL_PATH_RESET,
 			0x07
@@ -176,13 +180,19 @@ struct MPU6050 {
 		return result;
 	}
 
-	void bulkRead(DriverCallbacks<int16_t>&& callbacks) {
+	FifoHealth m_fifoHealth;
+	const FifoHealth& getFifoHealth() const { return m_fifoHealth; }
+
+	template <typename... Callbacks>
+	void bulkRead(DriverCallbacks<int16_t, Callbacks...>&& callbacks) {
 		const auto status = m_RegisterInterface.readReg(Regs::IntStatus);
 
 		if (status & (1 << MPU6050_INTERRUPT_FIFO_OFLOW_BIT)) {
 			// Overflows make it so we lose track of which packet is which
 			// This necessitates a reset
 			m_Logger.debug("Fifo overrun, resetting...");
+			m_fifoHealth.overruns++;
+			m_fifoHealth.recoveries++;
 			resetFIFO();
 			return;
 		}
@@ -190,6 +200,7 @@ struct MPU6050 {
 		std::array<uint8_t, 12 * 10>
 			readBuffer;  // max 10 packages of 12byte values (sample) of data form fifo
 		auto byteCount = byteSwap(m_RegisterInterface.readReg16(Regs::FifoCount));
+		m_fifoHealth.recordFillLevel(byteCount);
 
 		auto readBytes = min(static_cast<size_t>(byteCount), readBuffer.size())
 					   / sizeof(FifoSample) * sizeof(FifoSample);
@@ -0,0 +1,66 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace SlimeVR::Sensors::SoftFusion::Drivers {
+
+// Turns the raw FIFO timestamps of consecutive samples of one kind into the time
+// between them. Falls back to the nominal sample period for the first sample and
+// whenever the difference is implausible, e.g. after a FIFO overrun.
+template <uint32_t Mask = 0xffffffff>
+class SampleTimestamps {
+public:
+	float update(uint32_t timestamp, float tickSeconds, float nominalTs) {
+		const bool hadPrevious = m_valid;
+		const uint32_t ticks = (timestamp - m_last) & Mask;
+		m_last = timestamp;
+		m_valid = true;
+
+		if (!hadPrevious) {
+			return nominalTs;
+		}
+
+		const float elapsed = static_cast<float>(ticks) * tickSeconds;
+		if (elapsed < nominalTs * MinPeriodRatio
+			|| elapsed > nominalTs * MaxPeriodRatio) {
+			return nominalTs;
+		}
+
+		return elapsed;
+	}
+
+	void invalidate() { m_valid = false; }
+
+private:
+	// Allow a few dropped samples, anything beyond that is most likely an overrun
+	static constexpr float MinPeriodRatio = 0.5f;
+	static constexpr float MaxPeriodRatio = 4.0f;
+
+	uint32_t m_last = 0;
+	bool m_valid = false;
+};
+
+}  // namespace SlimeVR::Sensors::SoftFusion::Drivers
@@ -28,8 +28,22 @@
 #include <type_traits>
 
 #include "../../motionprocessing/types.h"
+#include "../SensorFusion.h"
 #include "drivers/callbacks.h"
 
+// Fusion backend for an IMU, drivers pick one by declaring a FusionBackend member
+// type, otherwise the board's SENSOR_FUSION_TYPE is used
+template <typename IMU>
+struct FusionBackendFor {
+	using type = SlimeVR::Sensors::DefaultFusionBackend;
+};
+
+template <typename IMU>
+	requires requires { typename IMU::FusionBackend; }
+struct FusionBackendFor<IMU> {
+	using type = typename IMU::FusionBackend;
+};
+
 template <typename IMU>
 struct IMUConsts {
 	static constexpr bool Uses32BitSensorData
@@ -37,12 +51,31 @@ struct IMUConsts {
 			  i.bulkRead(std::move(callbacks));
 		  };
 
+	static constexpr bool SupportsFifoInterrupt
+		= requires(IMU& i) { i.enableFifoInterrupt(); };
+
+	static constexpr bool SupportsSplitFifoRead
+		= requires(IMU& i) { i.startBulkRead(); };
+
+	// Drivers that split their reset or initialize() at long waits, see
+	// SoftFusionSensor::motionSetupStep()
+	static constexpr bool SupportsStepwiseReset
+		= requires(IMU& i) { i.continueReset(); };
+	static constexpr bool SupportsStepwiseInitialize
+		= requires(IMU& i) { i.finishInitialize(); };
+
+	static constexpr bool SupportsFifoHealth
+		= requires(const IMU& i) { i.getFifoHealth(); };
+
 	static constexpr bool DirectTempReadOnly = requires(IMU& i) { i.getDirectTemp(); };
 
 	using RawSensorT =
 		typename std::conditional<Uses32BitSensorData, int32_t, int16_t>::type;
 	using RawVectorT = std::array<RawSensorT, 3>;
 
+	using Fusion
+		= SlimeVR::Sensors::GenericSensorFusion<typename FusionBackendFor<IMU>::type>;
+
 	static constexpr float GScale
 		= ((32768. / IMU::GyroSensitivity) / 32768.) * (PI / 180.0);
 	static constexpr float AScale = CONST_EARTH_GRAVITY / IMU::AccelSensitivity;
@@ -57,6 +90,14 @@ struct IMUConsts {
 		}
 	}
 
+	static constexpr bool SupportsFifoTimestamps = []() constexpr {
+		if constexpr (requires { IMU::HasFifoTimestamps; }) {
+			return IMU::HasFifoTimestamps;
+		} else {
+			return false;
+		}
+	}();
+
 	static constexpr bool SupportsMags = requires(IMU& i) { i.readAux(0x00); };
 	static constexpr bool Supports9ByteMag = []() constexpr {
 		if constexpr (requires { IMU::Supports9ByteMag; }) {
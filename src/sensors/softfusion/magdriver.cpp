@@ -23,6 +23,8 @@
 
 #include "magdriver.h"
 
+#include <algorithm>
+
 namespace SlimeVR::Sensors::SoftFusion {
 
 std::vector<MagDefinition> MagDriver::supportedMags{
@@ -37,6 +39,8 @@ std::vector<MagDefinition> MagDriver::supportedMags{
 		.dataWidth = MagDataWidth::SixByte,
 		.dataReg = 0x01,
 
+		.axisRemap = {.axis = {0, 1, 2}, .sign = {1, 1, 1}},
+
 		.setup =
 			[](MagInterface& interface) {
 				interface.writeByte(0x0b, 0x80);
@@ -61,6 +65,8 @@ std::vector<MagDefinition> MagDriver::supportedMags{
 		.dataWidth = MagDataWidth::SixByte,
 		.dataReg = 0x11,
 
+		.axisRemap = {.axis = {0, 1, 2}, .sign = {1, 1, 1}},
+
 		.setup =
 			[](MagInterface& interface) {
 				interface.writeByte(0x32, 0x01);  // Soft reset
@@ -121,6 +127,19 @@ void MagDriver::stopPolling() const {
 	interface.stopPolling();
 }
 
+void MagDriver::remapToImuFrame(const int32_t magSample[3], int32_t imuSample[3])
+	const {
+	if (!detectedMag) {
+		std::copy(magSample, magSample + 3, imuSample);
+		return;
+	}
+
+	const auto& remap = detectedMag->axisRemap;
+	for (size_t i = 0; i < 3; i++) {
+		imuSample[i] = remap.sign[i] * magSample[remap.axis[i]];
+	}
+}
+
 const char* MagDriver::getAttachedMagName() const {
 	if (!detectedMag) {
 		return nullptr;
@@ -44,6 +44,12 @@ struct MagInterface {
 	std::function<void()> stopPolling;
 };
 
+// For every IMU axis, the mag axis that points the same way and its sign
+struct MagAxisRemap {
+	uint8_t axis[3];
+	int8_t sign[3];
+};
+
 struct MagDefinition {
 	const char* name;
 
@@ -55,6 +61,8 @@ struct MagDefinition {
 	MagDataWidth dataWidth;
 	uint8_t dataReg;
 
+	MagAxisRemap axisRemap;
+
 	std::function<bool(MagInterface& interface)> setup;
 };
 
@@ -64,6 +72,8 @@ public:
 	void startPolling() const;
 	void stopPolling() const;
 	[[nodiscard]] const char* getAttachedMagName() const;
+	// Turns a raw sample from the mag's axes into the IMU's
+	void remapToImuFrame(const int32_t magSample[3], int32_t imuSample[3]) const;
 
 private:
 	std::optional<MagDefinition> detectedMag;
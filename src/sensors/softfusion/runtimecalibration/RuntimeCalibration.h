@@ -51,9 +51,10 @@ public:
 	using Consts = typename Base::Consts;
 	using RawSensorT = typename Consts::RawSensorT;
 	using RawVectorT = typename Consts::RawVectorT;
+	using Fusion = typename Base::Fusion;
 
 	RuntimeCalibrator(
-		SensorFusion& fusion,
+		Fusion& fusion,
 		IMU& imu,
 		uint8_t sensorId,
 		Logging::Logger& logger,
@@ -174,6 +175,38 @@ public:
 		);
 	}
 
+	void scaleAccelBatch(
+		sensor_real_t x[],
+		sensor_real_t y[],
+		sensor_real_t z[],
+		size_t count
+	) final {
+		const sensor_real_t offX = activeCalibration.A_off[0];
+		const sensor_real_t offY = activeCalibration.A_off[1];
+		const sensor_real_t offZ = activeCalibration.A_off[2];
+		for (size_t i = 0; i < count; i++) {
+			x[i] = x[i] * Consts::AScale - offX;
+			y[i] = y[i] * Consts::AScale - offY;
+			z[i] = z[i] * Consts::AScale - offZ;
+		}
+	}
+
+	void scaleGyroBatch(
+		sensor_real_t x[],
+		sensor_real_t y[],
+		sensor_real_t z[],
+		size_t count
+	) final {
+		const sensor_real_t offX = activeCalibration.G_off1[0];
+		const sensor_real_t offY = activeCalibration.G_off1[1];
+		const sensor_real_t offZ = activeCalibration.G_off1[2];
+		for (size_t i = 0; i < count; i++) {
+			x[i] = Consts::GScale * (x[i] - offX);
+			y[i] = Consts::GScale * (y[i] - offY);
+			z[i] = Consts::GScale * (z[i] - offZ);
+		}
+	}
+
 	float getGyroTimestep() final { return activeCalibration.G_Ts; }
 
 	float getTempTimestep() final { return activeCalibration.T_Ts; }
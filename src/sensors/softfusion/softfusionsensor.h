@@ -25,6 +25,7 @@
 
 #include <PinInterface.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
@@ -32,6 +33,7 @@
 #include "../../sensorinterface/SensorInterface.h"
 #include "../RestCalibrationDetector.h"
 #include "../sensor.h"
+#include "SampleBatch.h"
 #include "TempGradientCalculator.h"
 #include "imuconsts.h"
 #include "motionprocessing/types.h"
@@ -84,10 +86,7 @@ class SoftFusionSensor : public Sensor {
 		}
 	}
 
-	void sendData() final {
-		Sensor::sendData();
-		sendTempIfNeeded();
-	}
+	void sendAuxiliaryData() final { sendTempIfNeeded(); }
 
 	void sendTempIfNeeded() {
 		uint32_t now = micros();
@@ -106,28 +105,85 @@ class SoftFusionSensor : public Sensor {
 		);
 	}};
 
-	void processAccelSample(const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-		sensor_real_t accelData[]
-			= {static_cast<sensor_real_t>(xyz[0]),
-			   static_cast<sensor_real_t>(xyz[1]),
-			   static_cast<sensor_real_t>(xyz[2])};
+	void queueAccelSample(const RawSensorT xyz[3], const sensor_real_t sensorTs) {
+		if constexpr (Consts::SupportsFifoTimestamps) {
+			m_accelBatch.push(xyz, sensorTs * m_sensorClockScale);
+		} else {
+			m_accelBatch.push(xyz, calibrator.getAccelTimestep());
+		}
+		calibrator.provideAccelSample(xyz);
+		if (m_accelBatch.full()) {
+			processSampleBatches();
+		}
+	}
 
-		calibrator.scaleAccelSample(accelData);
+	void queueGyroSample(const RawSensorT xyz[3], const sensor_real_t sensorTs) {
+		if constexpr (Consts::SupportsFifoTimestamps) {
+			m_gyroBatch.push(xyz, sensorTs * m_sensorClockScale);
+		} else {
+			m_gyroBatch.push(xyz, calibrator.getGyroTimestep());
+		}
+		calibrator.provideGyroSample(xyz);
+		if (m_gyroBatch.full()) {
+			processSampleBatches();
+		}
+	}
 
-		m_fusion.updateAcc(accelData, calibrator.getAccelTimestep());
+	void processMagSample(const int32_t xyz[3], const sensor_real_t timeDelta) {
+		if (!calibrator.hasMagCalibration()) {
+			return;
+		}
 
-		calibrator.provideAccelSample(xyz);
+		// the queued gyro and accel samples are older than this one, fuse them first
+		// so the mag update lands at the right point in time
+		processSampleBatches();
+
+		int32_t imuFrame[3];
+		magDriver.remapToImuFrame(xyz, imuFrame);
+		sensor_real_t mfxyz[3]{
+			static_cast<sensor_real_t>(imuFrame[0]),
+			static_cast<sensor_real_t>(imuFrame[1]),
+			static_cast<sensor_real_t>(imuFrame[2]),
+		};
+		calibrator.scaleMagSample(mfxyz);
+		m_fusion.updateMag(mfxyz, timeDelta);
 	}
 
-	void processGyroSample(const RawSensorT xyz[3], const sensor_real_t timeDelta) {
-		sensor_real_t gyroData[]
-			= {static_cast<sensor_real_t>(xyz[0]),
-			   static_cast<sensor_real_t>(xyz[1]),
-			   static_cast<sensor_real_t>(xyz[2])};
-		calibrator.scaleGyroSample(gyroData);
-		m_fusion.updateGyro(gyroData, calibrator.getGyroTimestep());
+	void processSampleBatches() {
+		calibrator.scaleAccelBatch(
+			m_accelBatch.x,
+			m_accelBatch.y,
+			m_accelBatch.z,
+			m_accelBatch.count
+		);
+		calibrator.scaleGyroBatch(
+			m_gyroBatch.x,
+			m_gyroBatch.y,
+			m_gyroBatch.z,
+			m_gyroBatch.count
+		);
 
-		calibrator.provideGyroSample(xyz);
+		const sensor_real_t* const gyroData[3]{
+			m_gyroBatch.x,
+			m_gyroBatch.y,
+			m_gyroBatch.z,
+		};
+		const sensor_real_t* const accelData[3]{
+			m_accelBatch.x,
+			m_accelBatch.y,
+			m_accelBatch.z,
+		};
+		m_fusion.updateBatch(
+			gyroData,
+			m_gyroBatch.dt,
+			m_gyroBatch.count,
+			accelData,
+			m_accelBatch.dt,
+			m_accelBatch.count
+		);
+
+		m_accelBatch.clear();
+		m_gyroBatch.clear();
 	}
 
 	void
@@ -176,7 +232,8 @@ public:
 			  SensorType::AccTs,
 			  SensorType::MagTs
 		  )
-		, m_sensor(registerInterface, m_Logger) {}
+		, m_sensor(registerInterface, m_Logger)
+		, m_intPin(intPin) {}
 	~SoftFusionSensor() override = default;
 
 	void checkSensorTimeout() {
@@ -193,18 +250,129 @@ public:
 			addr,
 			now - m_lastRotationUpdateMillis
 		);
-		networkConnection.sendSensorError(
-			this->sensorId,
-			static_cast<uint8_t>(PacketErrorCode::WATCHDOG_TIMEOUT)
+		sendSensorError(static_cast<uint8_t>(PacketErrorCode::WATCHDOG_TIMEOUT));
+	}
+
+	uint32_t drainFifo(uint32_t now) {
+		m_lastFifoDrainMicros = now;
+		uint32_t gyroSamples = 0;
+		sensor_real_t sensorSeconds = 0;
+		m_sensor.bulkRead(makeDriverCallbacks<RawSensorT>(
+			[&](const RawSensorT sample[3], float AccTs) {
+				queueAccelSample(sample, AccTs);
+			},
+			[&](const RawSensorT sample[3], float GyrTs) {
+				queueGyroSample(sample, GyrTs);
+				gyroSamples++;
+				sensorSeconds += GyrTs;
+			},
+			[&](int16_t sample, float TempTs) { processTempSample(sample, TempTs); },
+			[&](const int32_t sample[3], float MagTs) {
+				processMagSample(sample, MagTs);
+			}
+		));
+		processSampleBatches();
+		if constexpr (Consts::SupportsFifoTimestamps) {
+			updateSensorClockScale(now, sensorSeconds);
+		}
+		return gyroSamples;
+	}
+
+	// The calibrated sample rate measures the same oscillator the timestamps count,
+	// so the correction starts from there and is refined by the windows below
+	void seedSensorClockScale() {
+		m_seededGyroTimestep = calibrator.getGyroTimestep();
+		const float scale = m_seededGyroTimestep / SensorType::GyrTs;
+		m_sensorClockScale = scale > MinSensorClockScale && scale < MaxSensorClockScale
+							   ? scale
+							   : 1.0f;
+	}
+
+	// FIFO timestamps count in the sensor's own oscillator ticks, so compare the time
+	// they add up to with the host clock over longer windows to correct for the
+	// oscillator's frequency error
+	void updateSensorClockScale(uint32_t now, sensor_real_t sensorSeconds) {
+		if (calibrator.getGyroTimestep() != m_seededGyroTimestep) {
+			// the sample rate was just calibrated
+			seedSensorClockScale();
+		}
+
+		if (!m_sensorClockWindowStarted) {
+			m_sensorClockWindowStarted = true;
+			m_sensorClockWindowStartMicros = now;
+			m_sensorClockWindowSeconds = 0;
+			return;
+		}
+
+		m_sensorClockWindowSeconds += sensorSeconds;
+		const uint32_t windowMicros = now - m_sensorClockWindowStartMicros;
+		if (windowMicros < SensorClockWindowMicros) {
+			return;
+		}
+
+		const float ratio = static_cast<float>(windowMicros) * 1e-6f
+						  / static_cast<float>(m_sensorClockWindowSeconds);
+		// Windows with overruns or stalls are way off, ignore those
+		if (ratio > MinSensorClockScale && ratio < MaxSensorClockScale) {
+			m_sensorClockScale += (ratio - m_sensorClockScale) * SensorClockSmoothing;
+		}
+
+		m_sensorClockWindowStartMicros = now;
+		m_sensorClockWindowSeconds = 0;
+	}
+
+	void adaptPollInterval(uint32_t gyroSamples) {
+		// Aim for a handful of gyro samples per drain: poll sooner while the FIFO
+		// keeps filling up, back off again once it comes back (nearly) empty
+		if (gyroSamples > TargetSamplesPerDrain) {
+			m_pollIntervalMicros
+				= std::max(MinPollIntervalMicros, m_pollIntervalMicros * 3 / 4);
+		} else if (gyroSamples < TargetSamplesPerDrain / 2) {
+			m_pollIntervalMicros = std::min(
+				MaxPollIntervalMicros,
+				m_pollIntervalMicros + PollIntervalStepMicros
+			);
+		}
+	}
+
+	bool fifoInterruptPending(uint32_t now) {
+		if (m_intPin->digitalRead() == HIGH) {
+			m_missedFifoInterrupts = 0;
+			m_fifoInterruptTimedOut = false;
+			return true;
+		}
+
+		// Fall back to polling if nothing was read for a while, in case the interrupt
+		// line got stuck or a level change was missed
+		m_fifoInterruptTimedOut
+			= now - m_lastFifoDrainMicros >= FifoInterruptTimeoutMicros;
+		return m_fifoInterruptTimedOut;
+	}
+
+	void checkFifoInterruptWiring(uint32_t gyroSamples) {
+		// Every watermark is below the timeout, so finding data on a timed out drain
+		// means the line didn't go high when it should have
+		if (!m_fifoInterruptTimedOut || gyroSamples == 0) {
+			return;
+		}
+
+		m_missedFifoInterrupts++;
+		if (m_missedFifoInterrupts < MaxMissedFifoInterrupts) {
+			return;
+		}
+
+		m_Logger.warn(
+			"FIFO interrupt on %s never fired, polling instead",
+			m_intPin->toString().c_str()
 		);
+		m_fifoInterruptEnabled = false;
 	}
 
-	void motionLoop() final {
+	// Everything that needs the bus. Drivers with a split FIFO read only start the
+	// data transfer here, so it can run while another sensor is being fused
+	void updateBus(uint32_t now) {
 		calibrator.tick();
 
-		// read fifo updating fusion
-		uint32_t now = micros();
-
 		if constexpr (Consts::DirectTempReadOnly) {
 			uint32_t tempElapsed = now - lastTempPollTime;
 			if (tempElapsed >= Consts::DirectTempReadTs * 1e6) {
@@ -225,33 +393,61 @@ public:
 			}
 		}
 
+		// drain the fifo independently of the send rate so slow sends can't overrun it
+		if (m_fifoInterruptEnabled) {
+			m_drainPending = fifoInterruptPending(now);
+		} else if (now - m_lastPollTime >= m_pollIntervalMicros) {
+			m_lastPollTime = now;
+			m_drainPending = true;
+		}
+
+		if (m_drainPending) {
+			m_drainMicros = now;
+			if constexpr (Consts::SupportsSplitFifoRead) {
+				m_sensor.startBulkRead();
+			}
+		}
+
+		m_busUpdated = true;
+	}
+
+	bool startUpdate() final {
+		if constexpr (Consts::SupportsSplitFifoRead) {
+			updateBus(micros());
+			return true;
+		} else {
+			return false;
+		}
+	}
+
+	void motionLoop() final {
+		// with a pipelined update the caller already waited for the reads
+		if (!m_busUpdated) {
+			updateBus(micros());
+			m_RegisterInterface.finishReads();
+		}
+		m_busUpdated = false;
+
 		if (toggles.getToggle(SensorToggles::TempGradientCalibrationEnabled)) {
 			tempGradientCalculator.tick();
 		}
 
-		constexpr uint32_t targetPollIntervalMicros = 6000;
-		uint32_t elapsed = now - m_lastPollTime;
-		if (elapsed >= targetPollIntervalMicros) {
-			m_lastPollTime = now - (elapsed - targetPollIntervalMicros);
+		if (m_drainPending) {
+			m_drainPending = false;
+			const uint32_t gyroSamples = drainFifo(m_drainMicros);
+			if (m_fifoInterruptEnabled) {
+				checkFifoInterruptWiring(gyroSamples);
+			} else {
+				adaptPollInterval(gyroSamples);
+			}
 		}
 
 		// send new fusion values when time is up
-		now = micros();
+		const uint32_t now = micros();
 		constexpr float maxSendRateHz = 100.0f;
 		constexpr uint32_t sendInterval = 1.0f / maxSendRateHz * 1e6f;
-		elapsed = now - m_lastRotationPacketSent;
+		uint32_t elapsed = now - m_lastRotationPacketSent;
 		if (elapsed >= sendInterval) {
-			m_sensor.bulkRead({
-				[&](const auto sample[3], float AccTs) {
-					processAccelSample(sample, AccTs);
-				},
-				[&](const auto sample[3], float GyrTs) {
-					processGyroSample(sample, GyrTs);
-				},
-				[&](int16_t sample, float TempTs) {
-					processTempSample(sample, TempTs);
-				},
-			});
 			if (!m_fusion.isUpdated()) {
 				checkSensorTimeout();
 				return;
@@ -262,20 +458,99 @@ public:
 
 			m_lastRotationPacketSent = now - (elapsed - sendInterval);
 
-			setFusedRotation(m_fusion.getQuaternionQuat());
 			setAcceleration(m_fusion.getLinearAccVec());
+			setFusedRotation(m_fusion.getQuaternionQuat());
 			optimistic_yield(100);
 		}
 
-		if (calibrationDetector.update(m_fusion)) {
+		if (calibrationDetector.update(m_fusion.getRestDetected())) {
 			markRestCalibrationComplete();
 		}
 	}
 
 	void motionSetup() final {
+		while (!motionSetupStep()) {
+			delay(1);
+		}
+	}
+
+	// The reset, and the power up of drivers that split initialize(), are waited
+	// for without blocking. Drivers with a long reset sequence (the BMI270 config
+	// upload) step through it here too.
+	bool motionSetupStep() final {
+		switch (m_setupState) {
+			case SetupState::Start:
+				if (!beginSetup()) {
+					m_setupState = SetupState::Done;
+					return true;
+				}
+				m_setupState = SetupState::ContinueReset;
+				return false;
+			case SetupState::ContinueReset:
+				if constexpr (Consts::SupportsStepwiseReset) {
+					if (!m_sensor.continueReset()) {
+						return false;
+					}
+					// the wait startReset() returned is for after the reset sequence
+					m_resetStartMillis = millis();
+				}
+				m_setupState = SetupState::WaitForReset;
+				return false;
+			case SetupState::WaitForReset:
+				if (millis() - m_resetStartMillis < m_resetWaitMillis) {
+					return false;
+				}
+				if constexpr (Consts::SupportsStepwiseInitialize) {
+					m_powerUpWaitMillis = withMotionlessCalibrationData(
+						[&](auto&... calibData) {
+							return m_sensor.startInitialize(calibData...);
+						}
+					);
+					m_powerUpStartMillis = millis();
+					m_setupState = SetupState::WaitForPowerUp;
+					return false;
+				}
+				finishSetup(withMotionlessCalibrationData([&](auto&... calibData) {
+					return m_sensor.initialize(calibData...);
+				}));
+				m_setupState = SetupState::Done;
+				return true;
+			case SetupState::WaitForPowerUp:
+				if constexpr (Consts::SupportsStepwiseInitialize) {
+					if (millis() - m_powerUpStartMillis < m_powerUpWaitMillis) {
+						return false;
+					}
+					finishSetup(m_sensor.finishInitialize());
+				}
+				m_setupState = SetupState::Done;
+				return true;
+			case SetupState::Done:
+				return true;
+		}
+		return true;
+	}
+
+	// Calls an initialize step of the driver, with the stored motionless calibration
+	// for the drivers that take one
+	template <typename Step>
+	auto withMotionlessCalibrationData(Step&& step) {
+		if constexpr (Calib::HasMotionlessCalib) {
+			typename SensorType::MotionlessCalibrationData calibData;
+			std::memcpy(
+				&calibData,
+				calibrator.getMotionlessCalibrationData(),
+				sizeof(calibData)
+			);
+			return step(calibData);
+		} else {
+			return step();
+		}
+	}
+
+	bool beginSetup() {
 		if (!detected()) {
 			m_status = SensorStatus::SENSOR_ERROR;
-			return;
+			return false;
 		}
 
 		SlimeVR::Configuration::SensorConfig sensorCalibration
@@ -303,37 +578,49 @@ public:
 
 		calibrator.begin();
 
-		bool initResult = false;
-
-		if constexpr (Calib::HasMotionlessCalib) {
-			typename SensorType::MotionlessCalibrationData calibData;
-			std::memcpy(
-				&calibData,
-				calibrator.getMotionlessCalibrationData(),
-				sizeof(calibData)
-			);
-			initResult = m_sensor.initialize(calibData);
-		} else {
-			initResult = m_sensor.initialize();
-		}
+		m_resetWaitMillis = m_sensor.startReset();
+		m_resetStartMillis = millis();
+		return true;
+	}
 
+	void finishSetup(bool initResult) {
 		if (!initResult) {
 			m_Logger.error("Sensor failed to initialize!");
 			m_status = SensorStatus::SENSOR_ERROR;
 			return;
 		}
 
+		if constexpr (Consts::SupportsFifoInterrupt) {
+			// Reading a pin behind an I/O expander is a bus transaction of its own,
+			// that costs more than the empty FIFO reads the interrupt would save
+			if (m_intPin != nullptr && m_intPin->isDirect()) {
+				m_intPin->pinMode(INPUT);
+				m_sensor.enableFifoInterrupt();
+				m_fifoInterruptEnabled = true;
+				m_Logger.info(
+					"Using FIFO watermark interrupt on %s",
+					m_intPin->toString().c_str()
+				);
+			}
+		}
+
+		if constexpr (Consts::SupportsFifoTimestamps) {
+			seedSensorClockScale();
+		}
+
 		m_status = SensorStatus::SENSOR_OK;
 		working = true;
 
 		calibrator.checkStartupCalibration();
 
 		if constexpr (Consts::SupportsMags) {
-			magDriver.init(
+			const bool magFound = magDriver.init(
 				SoftFusion::MagInterface{
 					.readByte
 					= [&](uint8_t address) { return m_sensor.readAux(address); },
-					.writeByte = [&](uint8_t address, uint8_t value) {},
+					.writeByte
+					= [&](uint8_t address, uint8_t value
+					  ) { m_sensor.writeAux(address, value); },
 					.setDeviceId
 					= [&](uint8_t deviceId) { m_sensor.setAuxId(deviceId); },
 					.startPolling
@@ -343,6 +630,9 @@ public:
 				},
 				Consts::Supports9ByteMag
 			);
+			if (magFound && !calibrator.hasMagCalibration()) {
+				m_Logger.info("Magnetometer is not calibrated, its data won't be used");
+			}
 
 			if (toggles.getToggle(SensorToggles::MagEnabled)) {
 				magDriver.startPolling();
@@ -360,6 +650,15 @@ public:
 		});
 	}
 
+	bool checkBusAccess() final {
+		for (size_t i = 0; i < BusCheckReads; i++) {
+			if (!detected()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	void startCalibration(int calibrationType) final {
 		calibrator.startCalibration(calibrationType);
 	}
@@ -371,12 +670,58 @@ public:
 
 	SensorStatus getSensorState() final { return m_status; }
 
-	SensorFusion m_fusion;
+	typename Consts::Fusion m_fusion;
 	SensorType m_sensor;
+
+	static constexpr uint32_t SensorClockWindowMicros = 5'000'000;
+	static constexpr float MinSensorClockScale = 0.9f;
+	static constexpr float MaxSensorClockScale = 1.1f;
+	static constexpr float SensorClockSmoothing = 0.25f;
+	float m_sensorClockScale = 1.0f;
+	float m_seededGyroTimestep = 0;
+	bool m_sensorClockWindowStarted = false;
+	uint32_t m_sensorClockWindowStartMicros = 0;
+	sensor_real_t m_sensorClockWindowSeconds = 0;
+
+	static constexpr size_t SampleBatchSize = 32;
+	SampleBatch<SampleBatchSize> m_accelBatch;
+	SampleBatch<SampleBatchSize> m_gyroBatch;
+
 	Calib calibrator{m_fusion, m_sensor, sensorId, m_Logger, toggles};
 
 	SensorStatus m_status = SensorStatus::SENSOR_OFFLINE;
+
+	enum class SetupState {
+		Start,
+		ContinueReset,
+		WaitForReset,
+		WaitForPowerUp,
+		Done,
+	};
+	SetupState m_setupState = SetupState::Start;
+	uint32_t m_resetStartMillis = 0;
+	uint32_t m_resetWaitMillis = 0;
+	uint32_t m_powerUpStartMillis = 0;
+	uint32_t m_powerUpWaitMillis = 0;
+	PinInterface* m_intPin = nullptr;
+	bool m_fifoInterruptEnabled = false;
+	bool m_fifoInterruptTimedOut = false;
+	uint32_t m_missedFifoInterrupts = 0;
+	// Above the ~10ms the drivers set their watermarks to, but close to the 10ms
+	// the poll interval backs off to
+	static constexpr uint32_t FifoInterruptTimeoutMicros = 15000;
+	static constexpr uint32_t MaxMissedFifoInterrupts = 8;
+	uint32_t m_lastFifoDrainMicros = micros();
+	static constexpr size_t BusCheckReads = 32;
+	bool m_busUpdated = false;
+	bool m_drainPending = false;
+	uint32_t m_drainMicros = 0;
 	uint32_t m_lastPollTime = micros();
+	static constexpr uint32_t TargetSamplesPerDrain = 4;
+	static constexpr uint32_t MinPollIntervalMicros = 1000;
+	static constexpr uint32_t MaxPollIntervalMicros = 10000;
+	static constexpr uint32_t PollIntervalStepMicros = 500;
+	uint32_t m_pollIntervalMicros = 5000;
 	uint32_t m_lastRotationUpdateMillis = 0;
 	uint32_t m_lastRotationPacketSent = 0;
 	uint32_t m_lastTemperaturePacketSent = 0;
@@ -404,6 +749,14 @@ public:
 		}
 	}
 
+	const FifoHealth* getFifoHealth() const final {
+		if constexpr (Consts::SupportsFifoHealth) {
+			return &m_sensor.getFifoHealth();
+		} else {
+			return nullptr;
+		}
+	}
+
 	const char* getAttachedMagnetometer() const final {
 		return magDriver.getAttachedMagName();
 	}
@@ -24,6 +24,7 @@
 #include "serialcommands.h"
 
 #include <CmdCallback.hpp>
+#include <cinttypes>
 
 #include "GlobalVars.h"
 #include "base64.hpp"
@@ -197,6 +198,7 @@ void printState() {
 	}
 	logger.info("%s", vendorBuffer);
 
+	auto sensorLock = sensorManager.lockSensors();
 	for (auto& sensor : sensorManager.getSensors()) {
 		logger.info(
 			"Sensor[%d]: %s (%.3f %.3f %.3f %.3f) is working: %s, had data: %s",
@@ -210,6 +212,31 @@ void printState() {
 		if (mag) {
 			logger.info("Sensor[%d] magnetometer: %s", sensor->getSensorId(), mag);
 		}
+		if (sensor->getDroppedFusedSamples() > 0) {
+			logger.info(
+				"Sensor[%d] dropped unsent samples: %" PRIu32,
+				sensor->getSensorId(),
+				sensor->getDroppedFusedSamples()
+			);
+		}
+		const auto* fifoHealth = sensor->getFifoHealth();
+		if (fifoHealth) {
+			logger.info(
+				"Sensor[%d] FIFO: overruns: %" PRIu32 ", invalid frames: %" PRIu32
+				", skipped frames: %" PRIu32 ", discarded bytes: %" PRIu32
+				", recoveries: %" PRIu32 ", fill: %" PRIu32 " bytes (peak %" PRIu32
+				"), deferred reads: %" PRIu32,
+				sensor->getSensorId(),
+				fifoHealth->overruns,
+				fifoHealth->invalidFrames,
+				fifoHealth->skippedFrames,
+				fifoHealth->discardedBytes,
+				fifoHealth->recoveries,
+				fifoHealth->pendingBytes,
+				fifoHealth->peakBytes,
+				fifoHealth->deferredReads
+			);
+		}
 	}
 	logger.info(
 		"Battery voltage: %.3f, level: %.1f%%",
@@ -325,6 +352,7 @@ void cmdGet(CmdParser* parser) {
 			statusManager.getStatus(),
 			wifiNetwork.getWiFiState()
 		);
+		auto sensorLock = sensorManager.lockSensors();
 		auto& sensor0 = sensorManager.getSensors()[0];
 		sensor0->motionLoop();
 		logger.info(
@@ -419,6 +447,7 @@ void cmdFactoryReset(CmdParser* parser) {
 
 void cmdTemperatureCalibration(CmdParser* parser) {
 	if (parser->getParamCount() > 1) {
+		auto sensorLock = sensorManager.lockSensors();
 		if (parser->equalCmdParam(1, "PRINT")) {
 			for (auto& sensor : sensorManager.getSensors()) {
 				sensor->printTemperatureCalibrationState();
@@ -469,6 +498,7 @@ void cmdDeleteCalibration(CmdParser* parser) {
 #if EXT_SERIAL_COMMANDS
 void cmdScanI2C(CmdParser* parser) {
 	logger.info("Forcing I2C scan...");
+	auto sensorLock = sensorManager.lockSensors();
 	I2CSCAN::scani2cports();
 }
 #endif
@@ -0,0 +1,166 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Simulated register map for driver tests. Registers are plain memory, except for
+// the FIFO data register, whose reads pop bytes queued with pushFifo(). Every
+// transaction is counted and can be made to take simulated bus time, so tests can
+// check both what a driver does on the bus and how long it would have taken
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sensorinterface/RegisterInterface.h"
+
+namespace SlimeVR::Sensors {
+
+struct FakeRegisterInterface : public RegisterInterface {
+	// Bytes returned by reads of an empty FIFO
+	static constexpr uint8_t EmptyFifoByte = 0x80;
+
+	explicit FakeRegisterInterface(uint8_t fifoDataReg, uint8_t address = 0x68)
+		: m_fifoDataReg(fifoDataReg)
+		, m_address(address) {}
+
+	mutable std::array<uint8_t, 256> registers{};
+	mutable std::deque<uint8_t> fifo;
+	// Every register write, in order
+	mutable std::vector<std::pair<uint8_t, uint8_t>> writes;
+	// Called after every byte written, to simulate how the sensor reacts
+	std::function<void(uint8_t regAddr, uint8_t value)> onWrite;
+
+	mutable uint32_t readTransactions = 0;
+	mutable uint32_t writeTransactions = 0;
+	mutable size_t bytesTransferred = 0;
+
+	// Simulated bus time, spent on every transaction
+	uint32_t microsPerTransaction = 0;
+	uint32_t microsPerByte = 0;
+
+	// Bus limit reported to the drivers, the RegisterInterface default if 0
+	size_t maxTransactionLength = 0;
+
+	void pushFifo(const uint8_t* data, size_t size) {
+		fifo.insert(fifo.end(), data, data + size);
+	}
+
+	void setReg16(uint8_t regAddr, uint16_t value) {
+		registers[regAddr] = value & 0xff;
+		registers[static_cast<uint8_t>(regAddr + 1)] = value >> 8;
+	}
+
+	uint32_t transactions() const { return readTransactions + writeTransactions; }
+
+	void resetCounters() {
+		readTransactions = 0;
+		writeTransactions = 0;
+		bytesTransferred = 0;
+		writes.clear();
+	}
+
+	uint8_t readReg(uint8_t regAddr) const override {
+		uint8_t value;
+		readBytes(regAddr, 1, &value);
+		return value;
+	}
+
+	uint16_t readReg16(uint8_t regAddr) const override {
+		uint8_t value[2];
+		readBytes(regAddr, 2, value);
+		return value[0] | (value[1] << 8);
+	}
+
+	void writeReg(uint8_t regAddr, uint8_t value) const override {
+		writeBytes(regAddr, 1, &value);
+	}
+
+	void writeReg16(uint8_t regAddr, uint16_t value) const override {
+		uint8_t bytes[2]{static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8)};
+		writeBytes(regAddr, 2, bytes);
+	}
+
+	void readBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const override {
+		transaction(size);
+		readTransactions++;
+		for (size_t i = 0; i < size; i++) {
+			if (regAddr == m_fifoDataReg) {
+				if (fifo.empty()) {
+					buffer[i] = EmptyFifoByte;
+				} else {
+					buffer[i] = fifo.front();
+					fifo.pop_front();
+				}
+			} else {
+				buffer[i] = registers[static_cast<uint8_t>(regAddr + i)];
+			}
+		}
+	}
+
+	void writeBytes(uint8_t regAddr, uint8_t size, uint8_t* buffer) const override {
+		transaction(size);
+		writeTransactions++;
+		for (size_t i = 0; i < size; i++) {
+			// Burst writes to a data port (like a config upload) stay on one
+			// register, like on the real sensors
+			const auto target = m_burstWriteRegs[regAddr]
+								  ? regAddr
+								  : static_cast<uint8_t>(regAddr + i);
+			registers[target] = buffer[i];
+			writes.emplace_back(target, buffer[i]);
+			if (onWrite) {
+				onWrite(target, buffer[i]);
+			}
+		}
+	}
+
+	size_t getMaxTransactionLength() const override {
+		return maxTransactionLength > 0 ? maxTransactionLength
+										: RegisterInterface::getMaxTransactionLength();
+	}
+
+	uint8_t getAddress() const override { return m_address; }
+	bool hasSensorOnBus() override { return true; }
+	std::string toString() const override { return "Fake"; }
+
+	void setBurstWriteReg(uint8_t regAddr) { m_burstWriteRegs[regAddr] = true; }
+
+private:
+	void transaction(size_t bytes) const {
+		bytesTransferred += bytes;
+		ArduinoMock::advanceMicros(microsPerTransaction + microsPerByte * bytes);
+	}
+
+	uint8_t m_fifoDataReg;
+	uint8_t m_address;
+	std::array<bool, 256> m_burstWriteRegs{};
+};
+
+}  // namespace SlimeVR::Sensors
@@ -0,0 +1,358 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Deterministic synthetic IMU recording for the fusion tests. The sensor alternates
+// between lying still and moving around, the true orientation is integrated in
+// double precision and the gyro, accel and mag samples are derived from it, with
+// optional gyro bias, noise and linear acceleration. Samples are generated on the
+// fly so that long recordings also fit on the MCU
+
+#pragma once
+
+#include <vqf.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace SyntheticMotion {
+
+// Same as DefaultVQFParams in SensorFusion.h, which can't be included here as it
+// pulls in the whole sensor stack
+constexpr VQFParams FirmwareParams = VQFParams{
+	.tauAcc = 2.0f,
+	.restMinT = 2.0f,
+	.restThGyr = 0.6f,
+	.restThAcc = 0.06f,
+};
+
+struct Config {
+	double gyrTs = 1.0 / 416;
+	// Accel and mag samples come every n-th gyro sample
+	int accEvery = 4;
+	int magEvery = 4;
+	double restSeconds = 4;
+	double motionSeconds = 6;
+	// Peak angular rate of the motion phases, rad/s
+	double maxRate = 2.0;
+	// Peak linear acceleration of the motion phases, m/s^2
+	double linearAcc = 1.0;
+	// Residual gyro bias the fusion has to deal with, rad/s
+	double gyrBias[3] = {0, 0, 0};
+	double gyrNoise = 0.002;  // rad/s
+	double accNoise = 0.005;  // m/s^2, well below restThAcc
+	double magNoise = 0.2;  // uT
+	uint32_t seed = 1;
+
+	double accTs() const { return gyrTs * accEvery; }
+	double magTs() const { return gyrTs * magEvery; }
+};
+
+struct Sample {
+	float gyr[3];  // rad/s
+	bool hasAcc;
+	float acc[3];  // m/s^2
+	bool hasMag;
+	float mag[3];  // uT
+	// True orientation after this sample, w x y z, sensor to earth frame
+	double truth[4];
+	bool moving;
+};
+
+inline void quatMultiply(const double a[4], const double b[4], double out[4]) {
+	double w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+	double x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+	double y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+	double z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+	out[0] = w;
+	out[1] = x;
+	out[2] = y;
+	out[3] = z;
+}
+
+// Rotates an earth frame vector into the sensor frame
+inline void toSensorFrame(const double q[4], const double v[3], double out[3]) {
+	double conj[4] = {q[0], -q[1], -q[2], -q[3]};
+	double vq[4] = {0, v[0], v[1], v[2]};
+	double tmp[4];
+	double result[4];
+	quatMultiply(conj, vq, tmp);
+	quatMultiply(tmp, q, result);
+	out[0] = result[1];
+	out[1] = result[2];
+	out[2] = result[3];
+}
+
+// atan2 instead of acos, which has no resolution left for small angles
+template <typename T>
+double angleBetweenDeg(const double a[3], const T b[3]) {
+	double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	double cross[3] = {
+		a[1] * b[2] - a[2] * b[1],
+		a[2] * b[0] - a[0] * b[2],
+		a[0] * b[1] - a[1] * b[0],
+	};
+	double crossNorm
+		= sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+	return atan2(crossNorm, dot) * 180 / M_PI;
+}
+
+// Error of the estimated up direction, the part of the orientation the accel
+// correction takes care of
+template <typename T>
+double inclinationErrorDeg(const double truth[4], const T estimate[4]) {
+	const double up[3] = {0, 0, 1};
+	double estimateQuat[4] = {estimate[0], estimate[1], estimate[2], estimate[3]};
+	double trueUp[3];
+	double estimatedUp[3];
+	toSensorFrame(truth, up, trueUp);
+	toSensorFrame(estimateQuat, up, estimatedUp);
+	return angleBetweenDeg(trueUp, estimatedUp);
+}
+
+// Signed rotation about the vertical axis between estimate and truth, in the earth
+// frame, -180 to 180 degrees
+template <typename T>
+double headingErrorDeg(const double truth[4], const T estimate[4]) {
+	double estimateQuat[4] = {estimate[0], estimate[1], estimate[2], estimate[3]};
+	double truthConj[4] = {truth[0], -truth[1], -truth[2], -truth[3]};
+	double delta[4];
+	quatMultiply(estimateQuat, truthConj, delta);
+	return atan2(
+			   2 * (delta[0] * delta[3] + delta[1] * delta[2]),
+			   1 - 2 * (delta[2] * delta[2] + delta[3] * delta[3])
+		   )
+		 * 180 / M_PI;
+}
+
+// Full rotation angle between estimate and truth
+template <typename T>
+double orientationErrorDeg(const double truth[4], const T estimate[4]) {
+	double estimateQuat[4] = {estimate[0], estimate[1], estimate[2], estimate[3]};
+	double truthConj[4] = {truth[0], -truth[1], -truth[2], -truth[3]};
+	double delta[4];
+	quatMultiply(estimateQuat, truthConj, delta);
+	double axisNorm
+		= sqrt(delta[1] * delta[1] + delta[2] * delta[2] + delta[3] * delta[3]);
+	return 2 * atan2(axisNorm, fabs(delta[0])) * 180 / M_PI;
+}
+
+class Generator {
+public:
+	explicit Generator(const Config& config)
+		: m_config(config)
+		, m_random(config.seed) {}
+
+	double time() const { return m_step * m_config.gyrTs; }
+
+	void next(Sample& sample) {
+		const double t = time();
+		const double period = m_config.restSeconds + m_config.motionSeconds;
+		const double phase = fmod(t, period) - m_config.restSeconds;
+		// smooth ramp in and out, so that the rest phases are really still
+		double envelope = 0;
+		if (phase > 0) {
+			envelope = sin(M_PI * phase / m_config.motionSeconds);
+			envelope *= envelope;
+		}
+
+		// body frame angular rate, held for the whole sample period
+		double rate[3] = {
+			envelope * m_config.maxRate * sin(2 * M_PI * 0.31 * t),
+			envelope * m_config.maxRate * sin(2 * M_PI * 0.53 * t + 1),
+			envelope * m_config.maxRate * 0.7 * sin(2 * M_PI * 0.17 * t + 2),
+		};
+		double angle = sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2])
+					 * m_config.gyrTs;
+		if (angle > 0) {
+			double axisScale = sin(angle / 2) / (angle / m_config.gyrTs);
+			double step[4] = {
+				cos(angle / 2),
+				rate[0] * axisScale,
+				rate[1] * axisScale,
+				rate[2] * axisScale,
+			};
+			quatMultiply(m_orientation, step, m_orientation);
+			normalize(m_orientation);
+		}
+
+		for (int i = 0; i < 3; i++) {
+			sample.gyr[i] = static_cast<float>(
+				rate[i] + m_config.gyrBias[i] + m_config.gyrNoise * gaussian()
+			);
+		}
+
+		sample.hasAcc = m_step % m_config.accEvery == 0;
+		if (sample.hasAcc) {
+			const double a = envelope * m_config.linearAcc;
+			const double accEarth[3] = {
+				a * sin(2 * M_PI * 1.1 * t),
+				a * cos(2 * M_PI * 0.7 * t),
+				9.81 + a * sin(2 * M_PI * 0.9 * t),
+			};
+			double acc[3];
+			toSensorFrame(m_orientation, accEarth, acc);
+			for (int i = 0; i < 3; i++) {
+				sample.acc[i]
+					= static_cast<float>(acc[i] + m_config.accNoise * gaussian());
+			}
+		}
+
+		sample.hasMag = m_step % m_config.magEvery == 0;
+		if (sample.hasMag) {
+			// pointing north and down, like in central Europe
+			const double magEarth[3] = {0, 20, -44};
+			double mag[3];
+			toSensorFrame(m_orientation, magEarth, mag);
+			for (int i = 0; i < 3; i++) {
+				sample.mag[i]
+					= static_cast<float>(mag[i] + m_config.magNoise * gaussian());
+			}
+		}
+
+		for (int i = 0; i < 4; i++) {
+			sample.truth[i] = m_orientation[i];
+		}
+		sample.moving = envelope > 0;
+		m_step++;
+	}
+
+private:
+	static void normalize(double q[4]) {
+		double norm = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+		for (int i = 0; i < 4; i++) {
+			q[i] /= norm;
+		}
+	}
+
+	// xorshift32 and Box-Muller, the same numbers on every platform
+	double uniform() {
+		m_random ^= m_random << 13;
+		m_random ^= m_random >> 17;
+		m_random ^= m_random << 5;
+		return (m_random + 0.5) / 4294967296.0;
+	}
+
+	double gaussian() {
+		return sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform());
+	}
+
+	Config m_config;
+	uint32_t m_random;
+	uint64_t m_step = 0;
+	double m_orientation[4] = {1, 0, 0, 0};
+};
+
+struct Accuracy {
+	double meanInclinationDeg = 0;
+	double maxInclinationDeg = 0;
+	// Heading error at the end of the recording. Without a magnetometer this is the
+	// drift, the fusion starts out with the true heading
+	double finalHeadingDeg = 0;
+	double maxOrientationDeg = 0;
+};
+
+// Runs a recording through a fusion backend (VQF, BasicVQFFusion, FixedPointFusion)
+// and compares its output with the truth, skipping the first settleSeconds
+template <typename Fusion>
+Accuracy measureAccuracy(
+	Fusion& fusion,
+	const Config& config,
+	double seconds,
+	bool useMag = false,
+	double settleSeconds = 10
+) {
+	Generator generator(config);
+	Sample sample;
+	Accuracy accuracy;
+	float quat[4];
+	uint64_t compared = 0;
+	while (generator.time() < seconds) {
+		generator.next(sample);
+		fusion.updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+		if (sample.hasAcc) {
+			fusion.updateAcc(sample.acc);
+		}
+		if (useMag && sample.hasMag) {
+			fusion.updateMag(sample.mag);
+		}
+		if (generator.time() < settleSeconds) {
+			continue;
+		}
+
+		if (useMag) {
+			fusion.getQuat9D(quat);
+		} else {
+			fusion.getQuat6D(quat);
+		}
+		double inclination = inclinationErrorDeg(sample.truth, quat);
+		accuracy.meanInclinationDeg += inclination;
+		accuracy.maxInclinationDeg = fmax(accuracy.maxInclinationDeg, inclination);
+		accuracy.maxOrientationDeg
+			= fmax(accuracy.maxOrientationDeg, orientationErrorDeg(sample.truth, quat));
+		accuracy.finalHeadingDeg = headingErrorDeg(sample.truth, quat);
+		compared++;
+	}
+	accuracy.meanInclinationDeg /= compared;
+	return accuracy;
+}
+
+// Fastest time to run one gyro sample through the fusion, along with the accel and
+// mag samples that come with it, and a quaternion read
+template <typename Fusion>
+double timePerGyroSample(Fusion& fusion, const Config& config, bool useMag = false) {
+	// small enough for the RAM of an ESP8266
+	constexpr int Samples = 128;
+	std::vector<Sample> samples(Samples);
+	Generator generator(config);
+	// start timing in the middle of a motion phase
+	while (generator.time() < config.restSeconds + config.motionSeconds / 2) {
+		generator.next(samples[0]);
+	}
+	for (auto& sample : samples) {
+		generator.next(sample);
+	}
+
+	float quat[4];
+	Benchmark::Ticks best = Benchmark::fastestOf(8, [&] {
+		for (auto& sample : samples) {
+			fusion.updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+			if (sample.hasAcc) {
+				fusion.updateAcc(sample.acc);
+			}
+			if (useMag && sample.hasMag) {
+				fusion.updateMag(sample.mag);
+			}
+			if (useMag) {
+				fusion.getQuat9D(quat);
+			} else {
+				fusion.getQuat6D(quat);
+			}
+		}
+	});
+	return double(best) / Samples;
+}
+
+}  // namespace SyntheticMotion
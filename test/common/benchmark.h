@@ -0,0 +1,90 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Tiny timing helper shared by the benchmarks in test/. On the MCU it counts CPU
+// cycles, on the host it falls back to nanoseconds of wall clock time; the unit
+// is printed along with every result so the two are never mixed up
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <unity.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace Benchmark {
+
+#ifdef ARDUINO
+// The cycle counter is 32 bit and wraps, so elapsed times are computed in 32 bit
+using Ticks = uint32_t;
+constexpr const char* Unit = "cycles";
+
+inline Ticks now() { return ESP.getCycleCount(); }
+#else
+using Ticks = uint64_t;
+constexpr const char* Unit = "ns";
+
+inline Ticks now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch()
+	)
+		.count();
+}
+#endif
+
+// Runs fn() `rounds` times and returns the fastest round, which is the least
+// disturbed by interrupts and the scheduler. prepare() runs before every round and
+// isn't timed
+template <typename Prepare, typename Fn>
+Ticks fastestOf(int rounds, Prepare&& prepare, Fn&& fn) {
+	Ticks best = ~Ticks{0};
+	for (int i = 0; i < rounds; i++) {
+		prepare();
+		Ticks start = now();
+		fn();
+		Ticks elapsed = now() - start;
+		if (elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+template <typename Fn>
+Ticks fastestOf(int rounds, Fn&& fn) {
+	return fastestOf(rounds, [] {}, fn);
+}
+
+inline void report(const char* name, double perItem, const char* item) {
+	char message[96];
+	snprintf(message, sizeof(message), "%s: %.1f %s/%s", name, perItem, Unit, item);
+	TEST_MESSAGE(message);
+}
+
+}  // namespace Benchmark
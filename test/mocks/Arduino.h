@@ -0,0 +1,100 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Minimal stand-in for the Arduino core, so that drivers and fusion code can be
+// built for the native test environment. Time is simulated: it only advances
+// through delay(), delayMicroseconds() or ArduinoMock::advanceMicros(), which
+// keeps the tests deterministic and lets them measure how long a routine would
+// have blocked on hardware
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define PI 3.1415926535897932384626433832795
+#define PROGMEM
+
+using std::isnan;
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+namespace ArduinoMock {
+inline uint64_t nowMicros = 0;
+
+inline void advanceMicros(uint64_t us) { nowMicros += us; }
+inline void reset() { nowMicros = 0; }
+}  // namespace ArduinoMock
+
+inline unsigned long micros() {
+	return static_cast<unsigned long>(ArduinoMock::nowMicros);
+}
+inline unsigned long millis() {
+	return static_cast<unsigned long>(ArduinoMock::nowMicros / 1000);
+}
+inline void delay(unsigned long ms) { ArduinoMock::advanceMicros(ms * 1000ULL); }
+inline void delayMicroseconds(unsigned int us) { ArduinoMock::advanceMicros(us); }
+inline void yield() {}
+
+inline void* memcpy_P(void* dest, const void* src, size_t size) {
+	return memcpy(dest, src, size);
+}
+
+inline int digitalRead(uint8_t) { return LOW; }
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void pinMode(uint8_t, uint8_t) {}
+
+class HardwareSerial {
+public:
+	void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+		va_list args;
+		va_start(args, format);
+		vprintf(format, args);
+		va_end(args);
+	}
+	void print(const char* str) { fputs(str, stdout); }
+	void print(int value) { ::printf("%d", value); }
+	void print(unsigned int value) { ::printf("%u", value); }
+	void print(long value) { ::printf("%ld", value); }
+	void print(unsigned long value) { ::printf("%lu", value); }
+	void print(double value) { ::printf("%.2f", value); }
+	void println() { fputs("\n", stdout); }
+	void println(const char* str) { ::printf("%s\n", str); }
+};
+
+inline HardwareSerial Serial;
@@ -0,0 +1,253 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Counts the bus transactions and the simulated bus time the BMI270 config upload
+// takes, checks that it never blocks for long and that a warm start skips it
+
+#include <unity.h>
+
+#include <vector>
+
+#include "FakeRegisterInterface.h"
+#include "logging/Logger.h"
+#include "sensors/softfusion/drivers/bmi270.h"
+
+using namespace SlimeVR::Sensors;
+using namespace SlimeVR::Sensors::SoftFusion::Drivers;
+
+namespace {
+
+using Regs = BMI270::Regs;
+
+SlimeVR::Logging::Logger logger("Test");
+
+// A 400kHz I2C bus: 9 clocks per byte, plus start, address and stop
+constexpr uint32_t I2CMicrosPerByte = 23;
+constexpr uint32_t I2CMicrosPerTransaction = 30;
+// The register interfaces' longest transaction with the default 128 byte Wire
+// buffer, and on SPI
+constexpr size_t I2CMaxTransaction = RegisterInterface::MaxTransactionLength;
+constexpr size_t SPIMaxTransaction = 255;
+// SPI at 8MHz
+constexpr uint32_t SPIMicrosPerByte = 1;
+constexpr uint32_t SPIMicrosPerTransaction = 2;
+
+struct SimulatedBMI270 {
+	FakeRegisterInterface registers{Regs::FifoData, BMI270::Address};
+	std::vector<uint8_t> uploadedConfig;
+	uint32_t uploadTransactions = 0;
+
+	explicit SimulatedBMI270(size_t maxTransactionLength) {
+		registers.maxTransactionLength = maxTransactionLength;
+		registers.microsPerByte = I2CMicrosPerByte;
+		registers.microsPerTransaction = I2CMicrosPerTransaction;
+		registers.setBurstWriteReg(Regs::InitData);
+		registers.onWrite = [this](uint8_t regAddr, uint8_t value) {
+			if (regAddr == Regs::Cmd::reg && value == Regs::Cmd::valueSwReset) {
+				registers.registers[Regs::InternalStatus::reg] = 0;
+				uploadedConfig.clear();
+			} else if (regAddr == Regs::InitData) {
+				uploadedConfig.push_back(value);
+			} else if (regAddr == Regs::InitCtrl::reg
+					   && value == Regs::InitCtrl::valueEndInit) {
+				registers.registers[Regs::InternalStatus::reg]
+					= Regs::InternalStatus::messageInitOk;
+			}
+		};
+	}
+
+	void setConfigLoaded() {
+		registers.registers[Regs::InternalStatus::reg]
+			= Regs::InternalStatus::messageInitOk;
+	}
+
+	size_t initDataWrites() const {
+		size_t count = 0;
+		uint8_t lastReg = 0;
+		for (const auto& [regAddr, value] : registers.writes) {
+			// a burst shows up as a run of writes to InitData
+			if (regAddr == Regs::InitData && lastReg != Regs::InitData) {
+				count++;
+			}
+			lastReg = regAddr;
+		}
+		return count;
+	}
+};
+
+struct SetupResult {
+	bool initialized;
+	uint32_t resetWaitMillis;
+	uint64_t longestStepMicros;
+	uint64_t totalMicros;
+};
+
+// What SoftFusionSensor::motionSetupStep() does, with the time between its steps
+// (spent on the other sensors) simulated
+SetupResult runSetup(SimulatedBMI270& sensor) {
+	BMI270 imu{sensor.registers, logger};
+	BMI270::MotionlessCalibrationData calibration{};
+
+	ArduinoMock::reset();
+	uint64_t longestStepMicros = 0;
+	const auto step = [&](auto&& fn) {
+		const auto stepStart = ArduinoMock::nowMicros;
+		const auto result = fn();
+		longestStepMicros
+			= std::max(longestStepMicros, ArduinoMock::nowMicros - stepStart);
+		return result;
+	};
+
+	const auto resetWaitMillis = step([&] { return imu.startReset(); });
+	while (!step([&] { return imu.continueReset(); })) {
+		ArduinoMock::advanceMicros(100);
+	}
+	delay(resetWaitMillis);
+	delay(step([&] { return imu.startInitialize(calibration); }));
+	const bool initialized = step([&] { return imu.finishInitialize(); });
+
+	return {
+		initialized,
+		resetWaitMillis,
+		longestStepMicros,
+		ArduinoMock::nowMicros,
+	};
+}
+
+void report(
+	const char* name,
+	const SimulatedBMI270& sensor,
+	const SetupResult& result
+) {
+	char message[160];
+	snprintf(
+		message,
+		sizeof(message),
+		"%s: %u transactions, %u bytes, longest step %.1f ms, setup %.1f ms",
+		name,
+		static_cast<unsigned>(sensor.registers.transactions()),
+		static_cast<unsigned>(sensor.registers.bytesTransferred),
+		result.longestStepMicros / 1000.0,
+		result.totalMicros / 1000.0
+	);
+	TEST_MESSAGE(message);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_cold_start_uploads_the_config_in_full_chunks() {
+	SimulatedBMI270 sensor{I2CMaxTransaction};
+	const auto result = runSetup(sensor);
+
+	TEST_ASSERT_TRUE(result.initialized);
+	TEST_ASSERT_EQUAL(sizeof(bmi270_firmware), sensor.uploadedConfig.size());
+	TEST_ASSERT_EQUAL_MEMORY(
+		bmi270_firmware,
+		sensor.uploadedConfig.data(),
+		sizeof(bmi270_firmware)
+	);
+
+	// chunks stay even sized, positions are in words
+	const size_t chunkSize = I2CMaxTransaction & ~size_t{1};
+	const size_t chunks = (sizeof(bmi270_firmware) + chunkSize - 1) / chunkSize;
+	TEST_ASSERT_EQUAL(chunks, sensor.initDataWrites());
+	TEST_ASSERT_EQUAL(BMI270::ConfigLoadMillis, result.resetWaitMillis);
+	// a chunk at a time, the other sensors get the bus in between
+	TEST_ASSERT_LESS_THAN(10'000, result.longestStepMicros);
+
+	report("I2C cold start", sensor, result);
+}
+
+void test_spi_uploads_in_larger_chunks() {
+	SimulatedBMI270 sensor{SPIMaxTransaction};
+	sensor.registers.microsPerByte = SPIMicrosPerByte;
+	sensor.registers.microsPerTransaction = SPIMicrosPerTransaction;
+	const auto result = runSetup(sensor);
+
+	TEST_ASSERT_TRUE(result.initialized);
+	TEST_ASSERT_EQUAL_MEMORY(
+		bmi270_firmware,
+		sensor.uploadedConfig.data(),
+		sizeof(bmi270_firmware)
+	);
+	const size_t chunkSize = SPIMaxTransaction & ~size_t{1};
+	const size_t chunks = (sizeof(bmi270_firmware) + chunkSize - 1) / chunkSize;
+	TEST_ASSERT_EQUAL(chunks, sensor.initDataWrites());
+
+	report("SPI cold start", sensor, result);
+}
+
+void test_warm_start_skips_the_upload() {
+	SimulatedBMI270 cold{I2CMaxTransaction};
+	const auto coldResult = runSetup(cold);
+
+	SimulatedBMI270 warm{I2CMaxTransaction};
+	warm.setConfigLoaded();
+	const auto warmResult = runSetup(warm);
+
+	TEST_ASSERT_TRUE(warmResult.initialized);
+	TEST_ASSERT_EQUAL(0, warmResult.resetWaitMillis);
+	TEST_ASSERT_EQUAL(0, warm.initDataWrites());
+	for (const auto& [regAddr, value] : warm.registers.writes) {
+		TEST_ASSERT_FALSE(
+			regAddr == Regs::Cmd::reg && value == Regs::Cmd::valueSwReset
+		);
+	}
+	TEST_ASSERT_LESS_THAN(cold.registers.transactions(), warm.registers.transactions());
+	TEST_ASSERT_LESS_THAN(coldResult.totalMicros, warmResult.totalMicros);
+
+	report("I2C warm start", warm, warmResult);
+}
+
+void test_running_crt_forces_the_upload() {
+	SimulatedBMI270 sensor{I2CMaxTransaction};
+	sensor.setConfigLoaded();
+	sensor.registers.registers[Regs::GyrCrtConf::reg] = Regs::GyrCrtConf::valueRunning;
+	const auto result = runSetup(sensor);
+
+	TEST_ASSERT_TRUE(result.initialized);
+	TEST_ASSERT_EQUAL(sizeof(bmi270_firmware), sensor.uploadedConfig.size());
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_cold_start_uploads_the_config_in_full_chunks);
+	RUN_TEST(test_spi_uploads_in_larger_chunks);
+	RUN_TEST(test_warm_start_skips_the_upload);
+	RUN_TEST(test_running_crt_forces_the_upload);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,182 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Compares the template driver callbacks with the std::function callbacks they
+// replaced, by parsing the same simulated ICM-42688 FIFO backlog through both
+
+#include <unity.h>
+
+#include <cstring>
+#include <functional>
+
+#include "FakeRegisterInterface.h"
+#include "benchmark.h"
+#include "logging/Logger.h"
+#include "sensors/softfusion/drivers/icm42688.h"
+
+using namespace SlimeVR::Sensors;
+using namespace SlimeVR::Sensors::SoftFusion::Drivers;
+
+namespace {
+
+// As much as one FIFO read takes in
+constexpr size_t Entries
+	= ChunkedFifoReader<ICM42688::FullFifoEntrySize>::MaxTransactionsPerCall
+	* (RegisterInterface::MaxTransactionLength / ICM42688::FullFifoEntrySize);
+constexpr int Rounds = 200;
+
+// What SoftFusionSensor does with every sample, minus the fusion itself
+struct SampleSink {
+	float accel[3]{};
+	float gyro[3]{};
+	float temp = 0;
+	size_t samples = 0;
+
+	void accelSample(const int32_t sample[3], float Ts) {
+		for (size_t i = 0; i < 3; i++) {
+			accel[i] += static_cast<float>(sample[i]) * Ts;
+		}
+		samples++;
+	}
+
+	void gyroSample(const int32_t sample[3], float Ts) {
+		for (size_t i = 0; i < 3; i++) {
+			gyro[i] += static_cast<float>(sample[i]) * Ts;
+		}
+		samples++;
+	}
+
+	void tempSample(int16_t sample, float Ts) { temp += sample * Ts; }
+};
+
+using LegacyCallbacks = DriverCallbacks<
+	int32_t,
+	std::function<void(const int32_t[3], float)>,
+	std::function<void(const int32_t[3], float)>,
+	std::function<void(int16_t, float)>,
+	std::function<void(const int32_t[3], float)>>;
+
+SlimeVR::Logging::Logger logger("Test");
+FakeRegisterInterface registerInterface{ICM42688::Regs::FifoData};
+uint16_t timestamp = 0;
+
+void queueFifoBacklog(ICM42688& imu) {
+	for (size_t i = 0; i < Entries; i++) {
+		uint8_t frame[ICM42688::FullFifoEntrySize]{};
+		frame[0] = 0b0110'1000;  // accel, gyro, 20 bit, ODR timestamp
+		ICM42688::FifoEntryAligned entry{};
+		for (int16_t axis = 0; axis < 3; axis++) {
+			entry.part.accel[axis] = static_cast<int16_t>(100 * axis + i);
+			entry.part.gyro[axis] = static_cast<int16_t>(-50 * axis - i);
+		}
+		entry.part.temp = 300;
+		timestamp += 5000;
+		entry.part.timestamp = timestamp;
+		memcpy(frame + 1, entry.raw, sizeof(entry.raw));
+		registerInterface.pushFifo(frame, sizeof(frame));
+	}
+	registerInterface.setReg16(
+		ICM42688::Regs::FifoCount,
+		static_cast<uint16_t>(registerInterface.fifo.size())
+	);
+	imu.startBulkRead();
+}
+
+void readWithTemplateCallbacks(ICM42688& imu, SampleSink& sink) {
+	imu.bulkRead(makeDriverCallbacks<int32_t>(
+		[&](const int32_t sample[3], float Ts) { sink.accelSample(sample, Ts); },
+		[&](const int32_t sample[3], float Ts) { sink.gyroSample(sample, Ts); },
+		[&](int16_t sample, float Ts) { sink.tempSample(sample, Ts); }
+	));
+}
+
+void readWithStdFunctionCallbacks(ICM42688& imu, SampleSink& sink) {
+	imu.bulkRead(LegacyCallbacks{
+		[&](const int32_t sample[3], float Ts) { sink.accelSample(sample, Ts); },
+		[&](const int32_t sample[3], float Ts) { sink.gyroSample(sample, Ts); },
+		[&](int16_t sample, float Ts) { sink.tempSample(sample, Ts); },
+		[](const int32_t sample[3], float Ts) {},
+	});
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_callbacks_deliver_the_same_samples() {
+	SampleSink viaTemplate;
+	ICM42688 imu{registerInterface, logger};
+	queueFifoBacklog(imu);
+	readWithTemplateCallbacks(imu, viaTemplate);
+
+	SampleSink viaStdFunction;
+	ICM42688 legacyImu{registerInterface, logger};
+	queueFifoBacklog(legacyImu);
+	readWithStdFunctionCallbacks(legacyImu, viaStdFunction);
+
+	TEST_ASSERT_EQUAL(2 * Entries, viaTemplate.samples);
+	TEST_ASSERT_EQUAL(viaTemplate.samples, viaStdFunction.samples);
+	for (size_t i = 0; i < 3; i++) {
+		TEST_ASSERT_EQUAL_FLOAT(viaTemplate.accel[i], viaStdFunction.accel[i]);
+		TEST_ASSERT_EQUAL_FLOAT(viaTemplate.gyro[i], viaStdFunction.gyro[i]);
+	}
+	TEST_ASSERT_EQUAL_FLOAT(viaTemplate.temp, viaStdFunction.temp);
+}
+
+void test_bulk_read_cost_per_sample() {
+	SampleSink sink;
+	ICM42688 imu{registerInterface, logger};
+	const auto queue = [&] { queueFifoBacklog(imu); };
+	const auto templateTicks = Benchmark::fastestOf(Rounds, queue, [&] {
+		readWithTemplateCallbacks(imu, sink);
+	});
+	const auto stdFunctionTicks = Benchmark::fastestOf(Rounds, queue, [&] {
+		readWithStdFunctionCallbacks(imu, sink);
+	});
+
+	// Keeps the sink, and so the callbacks, from being optimized out
+	TEST_ASSERT_EQUAL(2 * Rounds * 2 * Entries, sink.samples);
+
+	const double samples = 2 * Entries;
+	Benchmark::report("template callbacks", templateTicks / samples, "sample");
+	Benchmark::report("std::function callbacks", stdFunctionTicks / samples, "sample");
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_callbacks_deliver_the_same_samples);
+	RUN_TEST(test_bulk_read_cost_per_sample);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,267 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Checks the FifoHealth counters the drivers keep, by feeding them FIFO contents
+// through a simulated register map
+
+#include <unity.h>
+
+#include <cstring>
+#include <vector>
+
+#include "FakeRegisterInterface.h"
+#include "logging/Logger.h"
+#include "sensors/softfusion/drivers/bmi160.h"
+#include "sensors/softfusion/drivers/icm42688.h"
+
+using namespace SlimeVR::Sensors;
+using namespace SlimeVR::Sensors::SoftFusion::Drivers;
+
+namespace {
+
+SlimeVR::Logging::Logger logger("Test");
+
+struct SampleCounter {
+	size_t accel = 0;
+	size_t gyro = 0;
+
+	auto callbacks() {
+		return makeDriverCallbacks<int32_t>(
+			[&](const int32_t sample[3], float Ts) { accel++; },
+			[&](const int32_t sample[3], float Ts) { gyro++; },
+			[](int16_t sample, float Ts) {}
+		);
+	}
+
+	auto callbacks16() {
+		return makeDriverCallbacks<int16_t>(
+			[&](const int16_t sample[3], float Ts) { accel++; },
+			[&](const int16_t sample[3], float Ts) { gyro++; },
+			[](int16_t sample, float Ts) {}
+		);
+	}
+};
+
+namespace ICM42688Fifo {
+
+constexpr uint8_t AccelGyroHeader = 0b0110'1000;
+constexpr uint8_t EmptyHeader = 0b1000'0000;
+
+void pushFrame(
+	FakeRegisterInterface& registers,
+	uint8_t header = AccelGyroHeader,
+	int16_t gyroX = 1
+) {
+	uint8_t frame[ICM42688::FullFifoEntrySize]{};
+	frame[0] = header;
+	ICM42688::FifoEntryAligned entry{};
+	entry.part.gyro[0] = gyroX;
+	entry.part.accel[0] = 1;
+	entry.part.temp = 300;
+	memcpy(frame + 1, entry.raw, sizeof(entry.raw));
+	registers.pushFifo(frame, sizeof(frame));
+}
+
+void read(ICM42688& imu, FakeRegisterInterface& registers, SampleCounter& counter) {
+	registers.setReg16(
+		ICM42688::Regs::FifoCount,
+		static_cast<uint16_t>(registers.fifo.size())
+	);
+	imu.startBulkRead();
+	imu.bulkRead(counter.callbacks());
+}
+
+}  // namespace ICM42688Fifo
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_icm42688_tracks_fill_level_and_peak() {
+	FakeRegisterInterface registers{ICM42688::Regs::FifoData};
+	ICM42688 imu{registers, logger};
+	SampleCounter counter;
+
+	for (int i = 0; i < 10; i++) {
+		ICM42688Fifo::pushFrame(registers);
+	}
+	ICM42688Fifo::read(imu, registers, counter);
+	TEST_ASSERT_EQUAL(
+		10 * ICM42688::FullFifoEntrySize,
+		imu.getFifoHealth().pendingBytes
+	);
+
+	ICM42688Fifo::pushFrame(registers);
+	ICM42688Fifo::read(imu, registers, counter);
+
+	const auto& health = imu.getFifoHealth();
+	TEST_ASSERT_EQUAL(ICM42688::FullFifoEntrySize, health.pendingBytes);
+	TEST_ASSERT_EQUAL(10 * ICM42688::FullFifoEntrySize, health.peakBytes);
+	TEST_ASSERT_EQUAL(11, counter.gyro);
+	TEST_ASSERT_EQUAL(0, health.overruns);
+	TEST_ASSERT_EQUAL(0, health.invalidFrames);
+}
+
+void test_icm42688_counts_overruns_of_a_full_fifo() {
+	FakeRegisterInterface registers{ICM42688::Regs::FifoData};
+	ICM42688 imu{registers, logger};
+	SampleCounter counter;
+
+	const size_t frames = ICM42688::FifoCapacityBytes / ICM42688::FullFifoEntrySize;
+	for (size_t i = 0; i < frames; i++) {
+		ICM42688Fifo::pushFrame(registers);
+	}
+	registers.setReg16(ICM42688::Regs::FifoCount, ICM42688::FifoCapacityBytes);
+	imu.startBulkRead();
+	imu.bulkRead(counter.callbacks());
+	TEST_ASSERT_EQUAL(1, imu.getFifoHealth().overruns);
+
+	// A full FIFO takes several reads, the rest isn't an overrun anymore
+	while (registers.fifo.size() >= ICM42688::FullFifoEntrySize) {
+		ICM42688Fifo::read(imu, registers, counter);
+	}
+	TEST_ASSERT_EQUAL(1, imu.getFifoHealth().overruns);
+	TEST_ASSERT_EQUAL(frames, counter.gyro);
+	TEST_ASSERT_EQUAL(0, imu.getFifoHealth().recoveries);
+}
+
+void test_icm42688_counts_invalid_samples() {
+	FakeRegisterInterface registers{ICM42688::Regs::FifoData};
+	ICM42688 imu{registers, logger};
+	SampleCounter counter;
+
+	ICM42688Fifo::pushFrame(registers);
+	ICM42688Fifo::pushFrame(registers, ICM42688Fifo::AccelGyroHeader, -32768);
+	ICM42688Fifo::pushFrame(registers);
+	ICM42688Fifo::read(imu, registers, counter);
+
+	TEST_ASSERT_EQUAL(1, imu.getFifoHealth().invalidFrames);
+	TEST_ASSERT_EQUAL(2, counter.gyro);
+	// the accel sample of the frame is still good
+	TEST_ASSERT_EQUAL(3, counter.accel);
+	TEST_ASSERT_EQUAL(0, imu.getFifoHealth().recoveries);
+}
+
+void test_icm42688_recovers_from_corrupted_frames() {
+	FakeRegisterInterface registers{ICM42688::Regs::FifoData};
+	ICM42688 imu{registers, logger};
+	SampleCounter counter;
+
+	ICM42688Fifo::pushFrame(registers);
+	ICM42688Fifo::pushFrame(registers, ICM42688Fifo::EmptyHeader);
+	ICM42688Fifo::pushFrame(registers);
+	ICM42688Fifo::read(imu, registers, counter);
+
+	const auto& health = imu.getFifoHealth();
+	TEST_ASSERT_EQUAL(1, counter.gyro);
+	TEST_ASSERT_EQUAL(1, health.invalidFrames);
+	TEST_ASSERT_EQUAL(1, health.recoveries);
+	TEST_ASSERT_EQUAL(2 * ICM42688::FullFifoEntrySize, health.discardedBytes);
+
+	// The next read flushes the FIFO instead of reading it
+	registers.resetCounters();
+	ICM42688Fifo::pushFrame(registers);
+	imu.startBulkRead();
+	TEST_ASSERT_EQUAL(0, registers.readTransactions);
+	TEST_ASSERT_EQUAL(1, registers.writes.size());
+	TEST_ASSERT_EQUAL(ICM42688::Regs::SignalPathReset::reg, registers.writes[0].first);
+	TEST_ASSERT_EQUAL(
+		ICM42688::Regs::SignalPathReset::valueFifoFlush,
+		registers.writes[0].second
+	);
+}
+
+void test_bmi160_counts_skipped_frames() {
+	FakeRegisterInterface registers{BMI160::Regs::FifoData};
+	BMI160 imu{registers, logger};
+	SampleCounter counter;
+
+	const uint8_t fifo[]{
+		BMI160::Fifo::DataFrame | BMI160::Fifo::GyrDataBit,
+		1, 0, 2, 0, 3, 0,
+		BMI160::Fifo::SkipFrame,
+		5,
+		BMI160::Fifo::DataFrame | BMI160::Fifo::GyrDataBit | BMI160::Fifo::AccelDataBit,
+		1, 0, 2, 0, 3, 0,
+		4, 0, 5, 0, 6, 0,
+	};
+	registers.pushFifo(fifo, sizeof(fifo));
+	registers.setReg16(BMI160::Regs::FifoLength, sizeof(fifo));
+	imu.bulkRead(counter.callbacks16());
+
+	const auto& health = imu.getFifoHealth();
+	TEST_ASSERT_EQUAL(1, health.overruns);
+	TEST_ASSERT_EQUAL(5, health.skippedFrames);
+	TEST_ASSERT_EQUAL(sizeof(fifo), health.pendingBytes);
+	TEST_ASSERT_EQUAL(2, counter.gyro);
+	TEST_ASSERT_EQUAL(1, counter.accel);
+}
+
+void test_bmi160_flushes_on_unknown_frames() {
+	FakeRegisterInterface registers{BMI160::Regs::FifoData};
+	BMI160 imu{registers, logger};
+	SampleCounter counter;
+
+	const uint8_t fifo[]{
+		BMI160::Fifo::DataFrame | BMI160::Fifo::GyrDataBit,
+		1, 0, 2, 0, 3, 0,
+		0x00,  // not a frame type that is enabled
+		1, 2, 3,
+	};
+	registers.pushFifo(fifo, sizeof(fifo));
+	registers.setReg16(BMI160::Regs::FifoLength, sizeof(fifo));
+	imu.bulkRead(counter.callbacks16());
+
+	const auto& health = imu.getFifoHealth();
+	TEST_ASSERT_EQUAL(1, counter.gyro);
+	TEST_ASSERT_EQUAL(1, health.invalidFrames);
+	TEST_ASSERT_EQUAL(1, health.recoveries);
+	TEST_ASSERT_EQUAL(3, health.discardedBytes);
+	TEST_ASSERT_EQUAL(
+		BMI160::Regs::Cmd::valueFifoFlush,
+		registers.writes.back().second
+	);
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_icm42688_tracks_fill_level_and_peak);
+	RUN_TEST(test_icm42688_counts_overruns_of_a_full_fifo);
+	RUN_TEST(test_icm42688_counts_invalid_samples);
+	RUN_TEST(test_icm42688_recovers_from_corrupted_frames);
+	RUN_TEST(test_bmi160_counts_skipped_frames);
+	RUN_TEST(test_bmi160_flushes_on_unknown_frames);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
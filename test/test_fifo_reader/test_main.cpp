@@ -0,0 +1,142 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Checks how ChunkedFifoReader splits a FIFO backlog into transactions and calls
+
+#include <unity.h>
+
+#include <cstdint>
+
+#include "FakeRegisterInterface.h"
+#include "sensors/softfusion/drivers/fiforeader.h"
+
+using namespace SlimeVR::Sensors;
+using namespace SlimeVR::Sensors::SoftFusion::Drivers;
+
+namespace {
+
+constexpr uint8_t FifoDataReg = 0x30;
+constexpr size_t EntrySize = 7;
+using Reader = ChunkedFifoReader<EntrySize>;
+
+// Entries of consecutive bytes, so reads that split or reorder them show up
+void queueEntries(FakeRegisterInterface& registers, size_t entries) {
+	static uint8_t next = 0;
+	for (size_t i = 0; i < entries * EntrySize; i++) {
+		registers.pushFifo(&next, 1);
+		next++;
+	}
+}
+
+bool isConsecutive(const Reader& reader, size_t bytes, uint8_t& expected) {
+	for (size_t i = 0; i < bytes; i++) {
+		if (reader.buffer[i] != expected++) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}  // namespace
+
+void setUp() { ArduinoMock::reset(); }
+void tearDown() {}
+
+void test_large_backlog_is_read_over_several_calls() {
+	FakeRegisterInterface registers{FifoDataReg};
+	Reader reader;
+	const size_t entriesPerTransaction
+		= RegisterInterface::MaxTransactionLength / EntrySize;
+	const size_t entriesPerCall
+		= entriesPerTransaction * Reader::MaxTransactionsPerCall;
+	const size_t backlog = entriesPerCall + entriesPerCall / 2;
+	queueEntries(registers, backlog);
+	uint8_t expected = registers.fifo.front();
+
+	reader.start(registers, FifoDataReg, backlog);
+	size_t bytes = reader.take();
+	TEST_ASSERT_EQUAL(entriesPerCall * EntrySize, bytes);
+	TEST_ASSERT_EQUAL(Reader::MaxTransactionsPerCall, registers.readTransactions);
+	TEST_ASSERT_TRUE(isConsecutive(reader, bytes, expected));
+
+	// The rest is still in the FIFO, the next call picks it up
+	const size_t rest = registers.fifo.size() / EntrySize;
+	TEST_ASSERT_EQUAL(backlog - entriesPerCall, rest);
+	reader.start(registers, FifoDataReg, rest);
+	bytes = reader.take();
+	TEST_ASSERT_EQUAL(rest * EntrySize, bytes);
+	TEST_ASSERT_TRUE(isConsecutive(reader, bytes, expected));
+	TEST_ASSERT_TRUE(registers.fifo.empty());
+
+	// The buffer never holds more than one call's worth
+	TEST_ASSERT_EQUAL(entriesPerCall * EntrySize, reader.buffer.size());
+}
+
+void test_blocking_reads_stop_once_the_budget_is_spent() {
+	FakeRegisterInterface registers{FifoDataReg};
+	// Every transaction blocks for more than half the budget
+	registers.microsPerTransaction = Reader::ReadBudgetMicros * 3 / 4;
+	Reader reader;
+	queueEntries(registers, 100);
+
+	reader.start(registers, FifoDataReg, 100);
+	TEST_ASSERT_EQUAL(2, registers.readTransactions);
+	TEST_ASSERT_EQUAL(
+		2 * (RegisterInterface::MaxTransactionLength / EntrySize) * EntrySize,
+		reader.take()
+	);
+}
+
+void test_transactions_hold_whole_entries() {
+	FakeRegisterInterface registers{FifoDataReg};
+	registers.maxTransactionLength = 3 * EntrySize - 1;
+	Reader reader;
+	queueEntries(registers, 5);
+	uint8_t expected = registers.fifo.front();
+
+	reader.start(registers, FifoDataReg, 5);
+	const size_t bytes = reader.take();
+	TEST_ASSERT_EQUAL(5 * EntrySize, bytes);
+	TEST_ASSERT_EQUAL(3, registers.readTransactions);
+	TEST_ASSERT_EQUAL(5 * EntrySize, registers.bytesTransferred);
+	TEST_ASSERT_TRUE(isConsecutive(reader, bytes, expected));
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_large_backlog_is_read_over_several_calls);
+	RUN_TEST(test_blocking_reads_stop_once_the_budget_is_spent);
+	RUN_TEST(test_transactions_hold_whole_entries);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,135 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Compares the accuracy and speed of FixedPointFusion with VQF on synthetic
+// recordings with rest and motion phases and linear acceleration
+
+#include <unity.h>
+#include <vqf.h>
+
+#include <cmath>
+
+#include "SyntheticMotion.h"
+#include "benchmark.h"
+#include "motionprocessing/FixedPointFusion.h"
+
+using namespace SyntheticMotion;
+
+namespace {
+
+constexpr double RecordingSeconds = 300;
+
+template <typename Fusion>
+Accuracy runRecording(const Config& config, bool useMag = false) {
+	Fusion fusion(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	return measureAccuracy(fusion, config, RecordingSeconds, useMag);
+}
+
+Config withBias(double degreesPerSecond) {
+	Config config;
+	const double bias = degreesPerSecond * M_PI / 180;
+	config.gyrBias[0] = bias;
+	config.gyrBias[1] = -bias;
+	config.gyrBias[2] = bias;
+	return config;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_inclination_and_heading_without_bias() {
+	for (double rate : {416.0, 200.0}) {
+		Config config;
+		config.gyrTs = 1 / rate;
+		config.accEvery = rate > 300 ? 4 : 2;
+
+		// VQF is at about 0.04 deg mean and 0.2 deg max inclination error here,
+		// the fixed point filter at 0.2 and 0.9
+		Accuracy vqf = runRecording<VQF>(config);
+		Accuracy fixedPoint = runRecording<FixedPointFusion>(config);
+		TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, vqf.meanInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(0.4f, 0.0f, fixedPoint.meanInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(1.5f, 0.0f, fixedPoint.maxInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, fixedPoint.finalHeadingDeg);
+	}
+}
+
+void test_rest_bias_estimation_limits_heading_drift() {
+	// 0.5 deg/s of bias on every axis would be 150 deg of heading drift over the
+	// recording, both filters estimate it while resting
+	Config config = withBias(0.5);
+	Accuracy vqf = runRecording<VQF>(config);
+	Accuracy fixedPoint = runRecording<FixedPointFusion>(config);
+	TEST_ASSERT_FLOAT_WITHIN(10.0f, 0.0f, vqf.finalHeadingDeg);
+	TEST_ASSERT_FLOAT_WITHIN(10.0f, 0.0f, fixedPoint.finalHeadingDeg);
+	TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, fixedPoint.meanInclinationDeg);
+}
+
+void test_magnetometer_heading_matches_vqf_frame() {
+	// Both have to settle on the same heading, north along y
+	Config config;
+	Accuracy vqf = runRecording<VQF>(config, true);
+	Accuracy fixedPoint = runRecording<FixedPointFusion>(config, true);
+	TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, vqf.finalHeadingDeg);
+	TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, fixedPoint.finalHeadingDeg);
+	TEST_ASSERT_FLOAT_WITHIN(1.5f, 0.0f, fixedPoint.maxOrientationDeg);
+}
+
+void test_benchmark_fusion_step() {
+	Config config;
+	VQF vqf(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	FixedPointFusion fixedPoint(
+		FirmwareParams,
+		config.gyrTs,
+		config.accTs(),
+		config.magTs()
+	);
+	Benchmark::report("VQF", timePerGyroSample(vqf, config), "gyro sample");
+	Benchmark::report(
+		"FixedPointFusion",
+		timePerGyroSample(fixedPoint, config),
+		"gyro sample"
+	);
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_inclination_and_heading_without_bias);
+	RUN_TEST(test_rest_bias_estimation_limits_heading_drift);
+	RUN_TEST(test_magnetometer_heading_matches_vqf_frame);
+	RUN_TEST(test_benchmark_fusion_step);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
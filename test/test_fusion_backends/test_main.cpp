@@ -0,0 +1,197 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Runs the fusion backends GenericSensorFusion can be built with over the same
+// synthetic recordings, to compare their accuracy, rest detection and speed
+
+#include <unity.h>
+#include <vqf.h>
+
+#include <cmath>
+#include <cstdio>
+
+#include "SyntheticMotion.h"
+#include "benchmark.h"
+#include "motionprocessing/BasicVQFFusion.h"
+#include "motionprocessing/FixedPointFusion.h"
+
+using namespace SyntheticMotion;
+
+namespace {
+
+constexpr double RecordingSeconds = 300;
+
+Config withBias(double degreesPerSecond) {
+	Config config;
+	const double bias = degreesPerSecond * M_PI / 180;
+	config.gyrBias[0] = bias;
+	config.gyrBias[1] = -bias;
+	config.gyrBias[2] = bias;
+	return config;
+}
+
+template <typename Backend>
+Accuracy runBackend(const char* name, double biasDegreesPerSecond) {
+	Config config = withBias(biasDegreesPerSecond);
+	Backend backend(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	Accuracy accuracy = measureAccuracy(backend, config, RecordingSeconds);
+
+	char message[112];
+	snprintf(
+		message,
+		sizeof(message),
+		"%s, bias %.1f deg/s: inclination %.2f deg mean, heading drift %.1f deg",
+		name,
+		biasDegreesPerSecond,
+		accuracy.meanInclinationDeg,
+		accuracy.finalHeadingDeg
+	);
+	TEST_MESSAGE(message);
+	return accuracy;
+}
+
+// Still phases in which rest was never detected, plus samples flagged as rest
+// while moving. The rest low-pass needs a few seconds to settle after the motion,
+// so the still phases are made long enough for that, and the motion needs a
+// moment to ramp up past the thresholds. A single noise sample above the
+// thresholds restarts restMinT, so rest is not expected on every still sample
+template <typename Backend>
+int restDetectionMismatches() {
+	constexpr double SettleSeconds = 6 * FirmwareParams.restFilterTau;
+	constexpr double RampSeconds = 1;
+
+	Config config;
+	config.restSeconds = FirmwareParams.restMinT + SettleSeconds + 3;
+	Backend backend(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	Generator generator(config);
+	Sample sample;
+	double movingSince = 0;
+	bool restSeenWhileStill = false;
+	int mismatches = 0;
+	while (generator.time() < 60) {
+		generator.next(sample);
+		backend.updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+		if (sample.hasAcc) {
+			backend.updateAcc(sample.acc);
+		}
+
+		const double t = generator.time();
+		if (sample.moving) {
+			if (movingSince == 0) {
+				movingSince = t;
+				mismatches += restSeenWhileStill ? 0 : 1;
+				restSeenWhileStill = false;
+			}
+			if (t - movingSince > RampSeconds) {
+				mismatches += backend.getRestDetected() ? 1 : 0;
+			}
+		} else {
+			movingSince = 0;
+			restSeenWhileStill |= backend.getRestDetected();
+		}
+	}
+	return mismatches;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_accuracy_without_bias() {
+	// about 0.04 deg for VQF and BasicVQF and 0.2 for the fixed point filter
+	for (const Accuracy& accuracy :
+		 {runBackend<VQF>("VQF", 0),
+		  runBackend<BasicVQFFusion>("BasicVQFFusion", 0),
+		  runBackend<FixedPointFusion>("FixedPointFusion", 0)}) {
+		TEST_ASSERT_FLOAT_WITHIN(0.4f, 0.0f, accuracy.meanInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, accuracy.finalHeadingDeg);
+	}
+}
+
+void test_accuracy_with_residual_bias() {
+	for (double bias : {0.1, 0.5}) {
+		Accuracy vqf = runBackend<VQF>("VQF", bias);
+		Accuracy basic = runBackend<BasicVQFFusion>("BasicVQFFusion", bias);
+		Accuracy fixedPoint = runBackend<FixedPointFusion>("FixedPointFusion", bias);
+
+		// Without the bias estimation BasicVQF only has the accel correction to
+		// keep the tilt, so its inclination and heading drift grow with the bias.
+		// Its heading is not checked, nothing corrects it in 6D
+		TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, vqf.meanInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, basic.meanInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, fixedPoint.meanInclinationDeg);
+		TEST_ASSERT_FLOAT_WITHIN(10.0f, 0.0f, vqf.finalHeadingDeg);
+		TEST_ASSERT_FLOAT_WITHIN(10.0f, 0.0f, fixedPoint.finalHeadingDeg);
+	}
+}
+
+void test_rest_detection() {
+	// the runtime calibration relies on this with every backend
+	TEST_ASSERT_EQUAL(0, restDetectionMismatches<VQF>());
+	TEST_ASSERT_EQUAL(0, restDetectionMismatches<BasicVQFFusion>());
+	TEST_ASSERT_EQUAL(0, restDetectionMismatches<FixedPointFusion>());
+}
+
+void test_benchmark_backends() {
+	Config config;
+	VQF vqf(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	BasicVQFFusion basic(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	FixedPointFusion fixedPoint(
+		FirmwareParams,
+		config.gyrTs,
+		config.accTs(),
+		config.magTs()
+	);
+	Benchmark::report("VQF", timePerGyroSample(vqf, config), "gyro sample");
+	Benchmark::report(
+		"BasicVQFFusion",
+		timePerGyroSample(basic, config),
+		"gyro sample"
+	);
+	Benchmark::report(
+		"FixedPointFusion",
+		timePerGyroSample(fixedPoint, config),
+		"gyro sample"
+	);
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_accuracy_without_bias);
+	RUN_TEST(test_accuracy_with_residual_bias);
+	RUN_TEST(test_rest_detection);
+	RUN_TEST(test_benchmark_backends);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
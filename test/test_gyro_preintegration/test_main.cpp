@@ -0,0 +1,169 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Checks VQF's gyro pre-integration: the series expansion of the step quaternion,
+// and that folding the samples between accel updates into one rotation gives the
+// same orientation as applying them one by one
+
+#include <unity.h>
+#include <vqf.h>
+
+#include <cmath>
+
+#include "SyntheticMotion.h"
+#include "benchmark.h"
+
+using namespace SyntheticMotion;
+
+namespace {
+
+void exactStepQuat(const double gyr[3], double Ts, double out[4]) {
+	double norm = sqrt(gyr[0] * gyr[0] + gyr[1] * gyr[1] + gyr[2] * gyr[2]);
+	double halfAngle = norm * Ts / 2;
+	out[0] = cos(halfAngle);
+	for (int i = 0; i < 3; i++) {
+		out[i + 1] = sin(halfAngle) * gyr[i] / norm;
+	}
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_step_quat_matches_exact_rotation() {
+	constexpr float Ts = 1.0f / 416;
+	const float direction[3] = {0.6f, -0.48f, 0.64f};
+	// both sides of the 0.25 rad half angle where the series is switched to trig
+	for (double halfAngle : {1e-6, 1e-4, 1e-2, 0.1, 0.2, 0.2499, 0.2501, 0.5, 1.0}) {
+		const double rate = 2 * halfAngle / Ts;
+		float gyr[3];
+		double gyrExact[3];
+		for (int i = 0; i < 3; i++) {
+			gyr[i] = static_cast<float>(direction[i] * rate);
+			gyrExact[i] = gyr[i];
+		}
+
+		float step[4];
+		double exact[4];
+		TEST_ASSERT_TRUE(VQF::gyrStepQuat(gyr, Ts, step));
+		exactStepQuat(gyrExact, Ts, exact);
+		for (int i = 0; i < 4; i++) {
+			TEST_ASSERT_FLOAT_WITHIN(1e-6f, exact[i], step[i]);
+		}
+	}
+
+	const float still[3] = {0, 0, 0};
+	float step[4];
+	TEST_ASSERT_FALSE(VQF::gyrStepQuat(still, Ts, step));
+}
+
+void test_pending_rotation_matches_sequential_steps() {
+	Config config;
+	VQF vqf(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	Generator generator(config);
+	Sample sample;
+
+	// Orientation from the last accel update on, with every gyro sample applied on
+	// its own in double precision. The bias only changes in updateAcc()
+	double reference[4] = {1, 0, 0, 0};
+	float bias[3] = {0, 0, 0};
+	double maxErrorDeg = 0;
+	while (generator.time() < 120) {
+		generator.next(sample);
+		vqf.updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+
+		if (sample.hasAcc) {
+			vqf.updateAcc(sample.acc);
+			float quat[4];
+			vqf.getQuat6D(quat);
+			for (int i = 0; i < 4; i++) {
+				reference[i] = quat[i];
+			}
+			vqf.getBiasEstimate(bias);
+			continue;
+		}
+
+		double gyr[3];
+		for (int i = 0; i < 3; i++) {
+			gyr[i] = double(sample.gyr[i]) - bias[i];
+		}
+		double step[4];
+		exactStepQuat(gyr, config.gyrTs, step);
+		quatMultiply(reference, step, reference);
+
+		float quat[4];
+		vqf.getQuat6D(quat);
+		maxErrorDeg = fmax(maxErrorDeg, orientationErrorDeg(reference, quat));
+	}
+
+	// float resolution of a quaternion is around 1e-5 deg
+	TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, maxErrorDeg);
+}
+
+void test_accuracy_on_recording() {
+	// about 0.3 deg worst case on this recording, set by the accel correction
+	// during linear acceleration
+	Config config;
+	VQF vqf(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	Accuracy accuracy = measureAccuracy(vqf, config, 300);
+	TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, accuracy.maxOrientationDeg);
+}
+
+void test_benchmark_gyro_update() {
+	constexpr int Samples = 1000;
+	constexpr float Ts = 1.0f / 416;
+	VQF vqf(FirmwareParams, Ts, 4 * Ts);
+	float gyr[3] = {0.3f, -0.2f, 0.1f};
+
+	Benchmark::Ticks best = Benchmark::fastestOf(5, [&] {
+		for (int i = 0; i < Samples; i++) {
+			gyr[i % 3] = -gyr[i % 3];
+			vqf.updateGyr(gyr, Ts);
+		}
+	});
+	float quat[4];
+	vqf.getQuat6D(quat);
+	TEST_ASSERT_FALSE(std::isnan(quat[0]));
+	Benchmark::report("VQF::updateGyr", double(best) / Samples, "sample");
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_step_quat_matches_exact_rotation);
+	RUN_TEST(test_pending_rotation_matches_sequential_steps);
+	RUN_TEST(test_accuracy_on_recording);
+	RUN_TEST(test_benchmark_gyro_update);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,239 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Checks the single precision Butterworth low-pass filters of VQF and RestDetection
+// against a double precision reference, and times them
+
+#include <unity.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include "benchmark.h"
+#include "motionprocessing/RestDetection.h"
+
+namespace {
+
+// Time constants and sampling times the filters run at in the firmware: rest
+// detection, tauAcc and tauMag at the gyro and accel rates of the common IMUs
+constexpr double FilterTaus[] = {0.5, 2.0, 9.0};
+constexpr double SampleTimes[] = {1.0 / 1000, 1.0 / 416, 1.0 / 104};
+
+// Second order Butterworth in transposed direct form II, computed in double. This
+// is the reference, and in float it's how VQF used to run the filters
+template <typename T>
+struct DirectFormFilter {
+	DirectFormFilter(double tau, double Ts, T x0) {
+		double fc = (M_SQRT2 / (2.0 * M_PI)) / tau;
+		double C = tan(M_PI * fc * Ts);
+		double D = C * C + sqrt(2) * C + 1;
+		double b0 = C * C / D;
+		b[0] = T(b0);
+		b[1] = T(2 * b0);
+		b[2] = T(b0);
+		a[0] = T(2 * (C * C - 1) / D);
+		a[1] = T((1 - sqrt(2) * C + C * C) / D);
+		// steady state for a constant input of x0
+		state[0] = x0 * (T(1) - b[0]);
+		state[1] = x0 * (b[2] - a[1]);
+	}
+
+	T step(T x) {
+		T y = b[0] * x + state[0];
+		state[0] = b[1] * x - a[0] * y + state[1];
+		state[1] = b[2] * x - a[1] * y;
+		return y;
+	}
+
+	T b[3];
+	T a[2];
+	T state[2];
+};
+
+struct FloatFilter {
+	FloatFilter(double tau, double Ts, float x0) {
+		VQF::filterCoeffs(tau, Ts, coeffs);
+		VQF::filterInitialState(x0, state);
+	}
+
+	float step(float x) { return VQF::filterStep(x, coeffs, state); }
+
+	float coeffs[3];
+	float state[2];
+};
+
+// Deterministic test signal: an accelerometer-like value around 9.81 with slow
+// motion and some noise
+struct TestSignal {
+	uint32_t random = 1;
+	uint32_t n = 0;
+
+	double next(double Ts) {
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		double noise = (random / 4294967296.0 - 0.5) * 0.1;
+		double t = Ts * n++;
+		return 9.81 + 0.5 * sin(2 * M_PI * 0.2 * t) + 0.2 * sin(2 * M_PI * 3.0 * t)
+			 + noise;
+	}
+};
+
+// Largest deviation from the double reference over 60 s of the test signal
+template <typename Filter>
+double maxErrorAgainstReference(double tau, double Ts) {
+	DirectFormFilter<double> reference(tau, Ts, 9.81);
+	Filter filter(tau, Ts, 9.81f);
+	TestSignal signal;
+
+	double maxError = 0;
+	for (int i = 0; i < static_cast<int>(60 / Ts); i++) {
+		double x = signal.next(Ts);
+		double error = fabs(filter.step(static_cast<float>(x)) - reference.step(x));
+		maxError = std::max(maxError, error);
+	}
+	return maxError;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_settles_to_the_input() {
+	for (double tau : FilterTaus) {
+		for (double Ts : SampleTimes) {
+			// Start at 0 and settle to a constant. The DC gain is exactly one, the
+			// only error left is a dead band of a few float steps, once the change
+			// per sample drops below the resolution of the state
+			FloatFilter filter(tau, Ts, 0.0f);
+			float y = 0;
+			for (int i = 0; i < static_cast<int>(20 * tau / Ts); i++) {
+				y = filter.step(9.81f);
+			}
+			TEST_ASSERT_FLOAT_WITHIN(5e-3f, 9.81f, y);
+		}
+	}
+}
+
+void test_matches_double_reference() {
+	for (double tau : FilterTaus) {
+		for (double Ts : SampleTimes) {
+			double svfError = maxErrorAgainstReference<FloatFilter>(tau, Ts);
+			double directFormError
+				= maxErrorAgainstReference<DirectFormFilter<float>>(tau, Ts);
+
+			// The direct form in float is off by up to 25% at the lowest cutoffs
+			TEST_ASSERT_FLOAT_WITHIN(5e-4f, 0.0f, svfError);
+			TEST_ASSERT_TRUE(10 * svfError < directFormError);
+		}
+	}
+}
+
+void test_rest_detection_filter_matches_vqf() {
+	RestDetection restDetection(1.0f / 416, 1.0f / 104);
+	float restCoeffs[3];
+	float vqfCoeffs[3];
+	restDetection.filterCoeffs(0.5f, 1.0f / 416, restCoeffs);
+	VQF::filterCoeffs(0.5f, 1.0f / 416, vqfCoeffs);
+	TEST_ASSERT_EQUAL_FLOAT_ARRAY(vqfCoeffs, restCoeffs, 3);
+
+	float restState[2] = {0, 0};
+	float vqfState[2] = {0, 0};
+	TestSignal signal;
+	for (int i = 0; i < 10000; i++) {
+		float x = static_cast<float>(signal.next(1.0 / 416));
+		float restOut = restDetection.filterStep(x, restCoeffs, restState);
+		float vqfOut = VQF::filterStep(x, vqfCoeffs, vqfState);
+		TEST_ASSERT_EQUAL_FLOAT(vqfOut, restOut);
+	}
+}
+
+void test_rest_detection_detects_rest_and_motion() {
+	constexpr float gyrTs = 1.0f / 416;
+	constexpr float accTs = 1.0f / 104;
+	RestDetection restDetection(gyrTs, accTs);
+	TestSignal signal;
+
+	// lying still with sensor noise, rest needs restMinTime to be detected
+	for (int i = 0; i < 416 * 3; i++) {
+		float noise = static_cast<float>(signal.next(gyrTs) - 9.81) * 0.01f;
+		float gyr[3] = {noise, -noise, 0.5f * noise};
+		restDetection.updateGyr(gyr);
+		if (i % 4 == 3) {
+			float acc[3] = {noise, 0, 9.81f + noise};
+			restDetection.updateAcc(accTs, acc);
+		}
+	}
+	TEST_ASSERT_TRUE(restDetection.getRestDetected());
+
+	float gyr[3] = {0.5f, 0, 0};
+	restDetection.updateGyr(gyr);
+	TEST_ASSERT_FALSE(restDetection.getRestDetected());
+}
+
+void test_benchmark_filter_vec() {
+	constexpr int Samples = 1000;
+	constexpr float Ts = 1.0f / 416;
+	float coeffs[3];
+	VQF::filterCoeffs(2.0f, Ts, coeffs);
+
+	// 9 elements, like the bias estimation filter of VQF's updateAcc()
+	float state[2 * 9];
+	float input[9];
+	float output[9];
+	for (int i = 0; i < 9; i++) {
+		VQF::filterInitialState(1.0f, state + 2 * i);
+		input[i] = 1.0f + 0.1f * i;
+	}
+
+	Benchmark::Ticks best = Benchmark::fastestOf(5, [&] {
+		for (int i = 0; i < Samples; i++) {
+			input[i % 9] += 1e-3f;
+			VQF::filterVec(input, 9, 2.0f, Ts, coeffs, state, output);
+		}
+	});
+	TEST_ASSERT_FALSE(std::isnan(output[0]));
+	Benchmark::report("VQF::filterVec, 9 elements", double(best) / Samples, "call");
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_settles_to_the_input);
+	RUN_TEST(test_matches_double_reference);
+	RUN_TEST(test_rest_detection_filter_matches_vqf);
+	RUN_TEST(test_rest_detection_detects_rest_and_motion);
+	RUN_TEST(test_benchmark_filter_vec);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
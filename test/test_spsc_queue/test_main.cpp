@@ -0,0 +1,207 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Checks the queue between the sensor task and the main loop, from one thread and
+// with the producer and consumer running concurrently
+
+#include <unity.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "sensors/SPSCQueue.h"
+
+using SlimeVR::SPSCQueue;
+
+namespace {
+
+struct Element {
+	uint32_t sequence = 0;
+	// Written together with the sequence, a torn copy makes them disagree
+	uint32_t check = 0;
+};
+
+constexpr uint32_t checkOf(uint32_t sequence) { return ~sequence * 2654435761u; }
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_pop_from_empty_queue_fails() {
+	SPSCQueue<Element, 4> queue;
+	Element element;
+
+	TEST_ASSERT_TRUE(queue.empty());
+	TEST_ASSERT_FALSE(queue.pop(element));
+}
+
+void test_push_to_full_queue_fails_and_keeps_contents() {
+	SPSCQueue<Element, 4> queue;
+	for (uint32_t i = 0; i < 4; i++) {
+		TEST_ASSERT_TRUE(queue.push({i, checkOf(i)}));
+	}
+	TEST_ASSERT_FALSE(queue.push({4, checkOf(4)}));
+
+	Element element;
+	for (uint32_t i = 0; i < 4; i++) {
+		TEST_ASSERT_TRUE(queue.pop(element));
+		TEST_ASSERT_EQUAL_UINT32(i, element.sequence);
+	}
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_indices_wrap_around_the_storage() {
+	SPSCQueue<Element, 4> queue;
+	Element element;
+	for (uint32_t i = 0; i < 4 * 10 + 3; i++) {
+		TEST_ASSERT_TRUE(queue.push({i, checkOf(i)}));
+		TEST_ASSERT_TRUE(queue.pop(element));
+		TEST_ASSERT_EQUAL_UINT32(i, element.sequence);
+	}
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_push_overwrite_evicts_the_oldest() {
+	SPSCQueue<Element, 4> queue;
+	for (uint32_t i = 0; i < 4; i++) {
+		TEST_ASSERT_TRUE(queue.pushOverwrite({i, checkOf(i)}));
+	}
+	TEST_ASSERT_FALSE(queue.pushOverwrite({4, checkOf(4)}));
+	TEST_ASSERT_FALSE(queue.pushOverwrite({5, checkOf(5)}));
+
+	Element element;
+	for (uint32_t i = 2; i < 6; i++) {
+		TEST_ASSERT_TRUE(queue.pop(element));
+		TEST_ASSERT_EQUAL_UINT32(i, element.sequence);
+	}
+	TEST_ASSERT_FALSE(queue.pop(element));
+}
+
+#if !defined(ARDUINO) || defined(ESP32)
+void test_concurrent_transfer_is_ordered_and_complete() {
+	constexpr uint32_t count = 1000000;
+	SPSCQueue<Element, 4> queue;
+
+	// The producer retries when the queue is full, so every element has to arrive
+	std::thread producer([&queue]() {
+		for (uint32_t i = 0; i < count; i++) {
+			while (!queue.push({i, checkOf(i)})) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t expected = 0;
+	uint32_t outOfOrder = 0;
+	uint32_t torn = 0;
+	Element element;
+	while (expected < count) {
+		if (!queue.pop(element)) {
+			std::this_thread::yield();
+			continue;
+		}
+		if (element.sequence != expected) {
+			outOfOrder++;
+		}
+		if (element.check != checkOf(element.sequence)) {
+			torn++;
+		}
+		expected = element.sequence + 1;
+	}
+	producer.join();
+
+	TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+	TEST_ASSERT_EQUAL_UINT32(0, torn);
+	TEST_ASSERT_FALSE(queue.pop(element));
+}
+
+void test_concurrent_overwrite_keeps_order_and_accounts_for_every_element() {
+	constexpr uint32_t count = 1000000;
+	SPSCQueue<Element, 4> queue;
+
+	// The producer never waits, whatever the consumer doesn't take in time is evicted.
+	// It yields now and then so that both evictions and pops happen a lot
+	uint32_t evicted = 0;
+	std::thread producer([&queue, &evicted]() {
+		for (uint32_t i = 0; i < count; i++) {
+			if (!queue.pushOverwrite({i, checkOf(i)})) {
+				evicted++;
+			}
+			if (i % 8 == 0) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t received = 0;
+	uint32_t next = 0;
+	uint32_t outOfOrder = 0;
+	uint32_t torn = 0;
+	Element element;
+	while (next < count) {
+		if (!queue.pop(element)) {
+			std::this_thread::yield();
+			continue;
+		}
+		received++;
+		if (element.sequence < next) {
+			outOfOrder++;
+		}
+		if (element.check != checkOf(element.sequence)) {
+			torn++;
+		}
+		next = element.sequence + 1;
+	}
+	producer.join();
+
+	TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+	TEST_ASSERT_EQUAL_UINT32(0, torn);
+	TEST_ASSERT_EQUAL_UINT32(count, received + evicted);
+	TEST_ASSERT_FALSE(queue.pop(element));
+}
+#endif
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_pop_from_empty_queue_fails);
+	RUN_TEST(test_push_to_full_queue_fails_and_keeps_contents);
+	RUN_TEST(test_indices_wrap_around_the_storage);
+	RUN_TEST(test_push_overwrite_evicts_the_oldest);
+#if !defined(ARDUINO) || defined(ESP32)
+	RUN_TEST(test_concurrent_transfer_is_ordered_and_complete);
+	RUN_TEST(test_concurrent_overwrite_keeps_order_and_accounts_for_every_element);
+#endif
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif
@@ -0,0 +1,229 @@
+/*
+	SlimeVR Code is placed under the MIT license
+	Copyright (c) 2025 SlimeVR Contributors
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+// Checks that VQF's cached outputs always match the filter state, and that reading
+// them doesn't change what the filter computes
+
+#include <unity.h>
+#include <vqf.h>
+
+#include <cstring>
+#include <vector>
+
+#include "SyntheticMotion.h"
+#include "benchmark.h"
+
+using namespace SyntheticMotion;
+
+namespace {
+
+// The outputs computed from the state from scratch, as VQF did before the cache
+void expectedQuat6D(const VQF& vqf, float out[4]) {
+	const VQFState& state = vqf.getState();
+	float gyrQuat[4];
+#ifdef VQF_GYR_PREINTEGRATION
+	VQF::quatMultiply(state.gyrQuat, state.gyrPreintQuat, gyrQuat);
+	VQF::normalize(gyrQuat, 4);
+#else
+	std::memcpy(gyrQuat, state.gyrQuat, sizeof(gyrQuat));
+#endif
+	VQF::quatMultiply(state.accQuat, gyrQuat, out);
+}
+
+void assertOutputsMatchState(const VQF& vqf) {
+	float quat6D[4];
+	float expected6D[4];
+	vqf.getQuat6D(quat6D);
+	expectedQuat6D(vqf, expected6D);
+	TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected6D, quat6D, 4);
+
+	float quat9D[4];
+	float expected9D[4];
+	vqf.getQuat9D(quat9D);
+	VQF::quatApplyDelta(expected6D, vqf.getDelta(), expected9D);
+	TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected9D, quat9D, 4);
+
+	// gravity in the sensor frame is the last row of the rotation matrix
+	const float* q = expected6D;
+	const float up[3] = {
+		2 * (q[1] * q[3] - q[0] * q[2]),
+		2 * (q[0] * q[1] + q[2] * q[3]),
+		1 - 2 * (q[1] * q[1] + q[2] * q[2]),
+	};
+	float rotation[9];
+	float gravity[3];
+	vqf.getRotationMatrix6D(rotation);
+	vqf.getGravity(gravity);
+	for (int i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(1e-6f, up[i], rotation[6 + i]);
+		TEST_ASSERT_FLOAT_WITHIN(1e-6f, up[i], gravity[i]);
+	}
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_outputs_follow_every_update() {
+	Config config;
+	VQF vqf(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	Generator generator(config);
+	Sample sample;
+	assertOutputsMatchState(vqf);
+
+	while (generator.time() < 30) {
+		generator.next(sample);
+		vqf.updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+		assertOutputsMatchState(vqf);
+		if (sample.hasAcc) {
+			vqf.updateAcc(sample.acc);
+			assertOutputsMatchState(vqf);
+		}
+		if (sample.hasMag) {
+			// a heading update leaves the 6D outputs alone
+			float before[4];
+			float after[4];
+			vqf.getQuat6D(before);
+			vqf.updateMag(sample.mag);
+			vqf.getQuat6D(after);
+			TEST_ASSERT_EQUAL_MEMORY(before, after, sizeof(before));
+			assertOutputsMatchState(vqf);
+		}
+	}
+
+	VQFState state = vqf.getState();
+	VQF::quatSetToIdentity(state.accQuat);
+	state.delta = 1.0f;
+	vqf.setState(state);
+	assertOutputsMatchState(vqf);
+
+	vqf.resetState();
+	assertOutputsMatchState(vqf);
+	float quat[4];
+	vqf.getQuat9D(quat);
+	TEST_ASSERT_EQUAL_FLOAT(1.0f, quat[0]);
+}
+
+void test_reading_outputs_does_not_change_results() {
+	Config config;
+	VQF reading(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	VQF silent(FirmwareParams, config.gyrTs, config.accTs(), config.magTs());
+	Generator generator(config);
+	Sample sample;
+
+	float out[9];
+	int step = 0;
+	while (generator.time() < 60) {
+		generator.next(sample);
+		for (VQF* vqf : {&reading, &silent}) {
+			vqf->updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+			if (sample.hasAcc) {
+				vqf->updateAcc(sample.acc);
+			}
+			if (sample.hasMag) {
+				vqf->updateMag(sample.mag);
+			}
+		}
+
+		// a different getter goes first every time
+		switch (step++ % 4) {
+			case 0:
+				reading.getQuat9D(out);
+				break;
+			case 1:
+				reading.getGravity(out);
+				break;
+			case 2:
+				reading.getRotationMatrix6D(out);
+				break;
+			case 3:
+				reading.getQuat6D(out);
+				break;
+		}
+		reading.getQuat6D(out);
+		reading.getQuat9D(out);
+	}
+
+	float readingQuat[4];
+	float silentQuat[4];
+	reading.getQuat9D(readingQuat);
+	silent.getQuat9D(silentQuat);
+	TEST_ASSERT_EQUAL_MEMORY(silentQuat, readingQuat, sizeof(readingQuat));
+
+	float readingBias[3];
+	float silentBias[3];
+	reading.getBiasEstimate(readingBias);
+	silent.getBiasEstimate(silentBias);
+	TEST_ASSERT_EQUAL_MEMORY(silentBias, readingBias, sizeof(readingBias));
+}
+
+void test_benchmark_update_and_read() {
+	// Per sensor loop with a 416 Hz gyro and a 104 Hz accel: four gyro samples and an
+	// accel sample, then the quaternion and gravity for the linear acceleration
+	Config config;
+	VQF vqf(FirmwareParams, config.gyrTs, config.accTs());
+	constexpr int Loops = 64;
+	std::vector<Sample> samples(Loops * config.accEvery);
+	Generator generator(config);
+	while (generator.time() < config.restSeconds + config.motionSeconds / 2) {
+		generator.next(samples[0]);
+	}
+	for (auto& sample : samples) {
+		generator.next(sample);
+	}
+
+	float quat[4];
+	float gravity[3];
+	Benchmark::Ticks best = Benchmark::fastestOf(8, [&] {
+		for (auto& sample : samples) {
+			vqf.updateGyr(sample.gyr, static_cast<float>(config.gyrTs));
+			if (sample.hasAcc) {
+				vqf.updateAcc(sample.acc);
+				vqf.getQuat6D(quat);
+				vqf.getGravity(gravity);
+			}
+		}
+	});
+	TEST_ASSERT_FALSE(std::isnan(gravity[2]));
+	Benchmark::report("VQF update and read", double(best) / Loops, "loop");
+}
+
+int runUnityTests() {
+	UNITY_BEGIN();
+	RUN_TEST(test_outputs_follow_every_update);
+	RUN_TEST(test_reading_outputs_does_not_change_results);
+	RUN_TEST(test_benchmark_update_and_read);
+	return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+	delay(2000);
+	runUnityTests();
+}
+
+void loop() {}
+#else
+int main() { return runUnityTests(); }
+#endif